@@ -172,6 +172,10 @@ private:
   bool channel_exists_directed(unsigned from, unsigned to, ChannelType ct) const;
   bool channel_exists_undirected(unsigned from, unsigned to, ChannelType ct) const;
 
+  // sufficient (but not necessary) condition for all automorphisms mapping
+  // the given (undirected) channel onto itself
+  bool channel_fixed(unsigned from, unsigned to, ChannelType ct) const;
+
   using pe_it = adjacency_type::vertex_iterator;
   using pe = pe_it::value_type;
 
@@ -56,13 +56,7 @@ private:
                                      internal::timeout::flag aborted) override;
 
   void init_repr_(AutomorphismOptions const *options,
-                  internal::timeout::flag aborted) override
-  {
-    for (auto const &subsystem : _subsystems) {
-      if (!subsystem->repr_ready())
-        subsystem->init_repr(options, aborted);
-    }
-  }
+                  internal::timeout::flag aborted) override;
 
   bool repr_ready_() const override
   {
@@ -80,11 +74,21 @@ private:
       subsystem->reset_repr();
   }
 
+  void prepare_repr_(ReprOptions const *options) override
+  {
+    for (auto const &subsystem : _subsystems)
+      subsystem->prepare_repr(options);
+  }
+
   TaskMapping repr_(TaskMapping const &mapping,
                     ReprOptions const *options,
                     TMORs *orbits,
                     internal::timeout::flag aborted) override;
 
+  // the same subsystem may have been added several times but must not be
+  // processed by several threads at once
+  std::vector<std::shared_ptr<ArchGraphSystem>> distinct_subsystems() const;
+
   std::vector<std::shared_ptr<ArchGraphSystem>> _subsystems;
 };
 
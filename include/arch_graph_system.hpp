@@ -1,13 +1,17 @@
 #ifndef GUARD_ARCH_GRAPH_SYSTEM_H
 #define GUARD_ARCH_GRAPH_SYSTEM_H
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <tuple>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "bsgs.hpp"
 #include "perm_group.hpp"
+#include "sparse_perm.hpp"
 #include "string.hpp"
 #include "task_mapping.hpp"
 #include "task_mapping_orbit.hpp"
@@ -24,7 +28,8 @@ struct ReprOptions
     ITERATE,
     LOCAL_SEARCH,
     ORBITS,
-    AUTO = ITERATE
+    BACKTRACK,
+    AUTO = BACKTRACK
   };
 
   enum class Variant {
@@ -47,6 +52,11 @@ struct ReprOptions
   bool match = true;
   bool optimize_symmetric = true;
 
+  // number of threads concurrently canonicalising the mapping slices of the
+  // subsystems of architecture graph clusters, zero uses all available
+  // hardware threads, note that threads are created anew on every call
+  unsigned cluster_threads = 1u;
+
   unsigned local_search_append_generators = 0u;
   unsigned local_search_sa_iterations = 100u;
   double local_search_sa_T_init = 1.0;
@@ -91,6 +101,7 @@ public:
   {
     _automorphisms_valid = false;
     _automorphisms_is_symmetric_valid = false;
+    _automorphisms_chain_valid = false;
   }
 
   virtual unsigned automorphisms_degree() const
@@ -106,8 +117,11 @@ public:
     internal::timeout::flag aborted = internal::timeout::unset())
   {
     if (!automorphisms_ready()) {
-      _automorphisms = automorphisms_(options, aborted);
+      _automorphisms = automorphisms_cached(options, aborted);
+      _automorphisms_options = AutomorphismOptions::fill_defaults(options);
       _automorphism_generators = _automorphisms.generators().with_inverses();
+      _automorphism_generators_sparse =
+        internal::sparse_perms(_automorphism_generators);
       _automorphisms_valid = true;
     }
 
@@ -142,6 +156,16 @@ public:
   void reset_repr()
   { reset_repr_(); }
 
+  // compute all state repr lazily initializes for the given options, after
+  // that repr may be called concurrently as long as these options are used
+  void prepare_repr(ReprOptions const *options = nullptr)
+  {
+    if (!repr_ready_())
+      init_repr();
+
+    prepare_repr_(options);
+  }
+
   TaskMapping repr(
     TaskMapping const &mapping,
     ReprOptions const *options = nullptr,
@@ -169,6 +193,67 @@ public:
     return std::make_tuple(representative, ins.first, ins.second);
   }
 
+  std::vector<TaskMapping> repr_batch(
+    TaskMapping const *mappings,
+    std::size_t num_mappings,
+    ReprOptions const *options = nullptr,
+    unsigned num_threads = 0u,
+    internal::timeout::flag aborted = internal::timeout::unset());
+
+  std::vector<TaskMapping> repr_batch(
+    std::vector<TaskMapping> const &mappings,
+    ReprOptions const *options = nullptr,
+    unsigned num_threads = 0u,
+    internal::timeout::flag aborted = internal::timeout::unset())
+  {
+    return repr_batch(mappings.data(),
+                      mappings.size(),
+                      options,
+                      num_threads,
+                      aborted);
+  }
+
+  std::vector<std::tuple<TaskMapping, bool, unsigned>> repr_batch(
+    TaskMapping const *mappings,
+    std::size_t num_mappings,
+    TMORs &orbits,
+    ReprOptions const *options = nullptr,
+    unsigned num_threads = 0u,
+    internal::timeout::flag aborted = internal::timeout::unset());
+
+  std::vector<std::tuple<TaskMapping, bool, unsigned>> repr_batch(
+    std::vector<TaskMapping> const &mappings,
+    TMORs &orbits,
+    ReprOptions const *options = nullptr,
+    unsigned num_threads = 0u,
+    internal::timeout::flag aborted = internal::timeout::unset())
+  {
+    return repr_batch(mappings.data(),
+                      mappings.size(),
+                      orbits,
+                      options,
+                      num_threads,
+                      aborted);
+  }
+
+protected:
+  // replace the automorphism group after a modification of the architecture
+  // graph that is known to result in exactly this group
+  void update_automorphisms(internal::PermGroup const &automorphisms)
+  {
+    reset_automorphisms();
+
+    _automorphisms = automorphisms;
+    _automorphism_generators = _automorphisms.generators().with_inverses();
+    _automorphism_generators_sparse =
+      internal::sparse_perms(_automorphism_generators);
+    _automorphisms_valid = true;
+  }
+
+  // options with which the current automorphism group was computed
+  AutomorphismOptions const *automorphisms_options() const
+  { return &_automorphisms_options; }
+
 private:
   virtual internal::BSGS::order_type num_automorphisms_(
     AutomorphismOptions const *options,
@@ -179,6 +264,10 @@ private:
     AutomorphismOptions const *options,
     internal::timeout::flag aborted) = 0;
 
+  internal::PermGroup automorphisms_cached(
+    AutomorphismOptions const *options,
+    internal::timeout::flag aborted);
+
   bool automorphisms_symmetric(ReprOptions const *options);
 
   virtual void init_repr_(AutomorphismOptions const *,
@@ -191,6 +280,8 @@ private:
   virtual void reset_repr_()
   { reset_automorphisms(); }
 
+  virtual void prepare_repr_(ReprOptions const *options);
+
   virtual TaskMapping repr_(TaskMapping const &mapping,
                             ReprOptions const *options,
                             TMORs *orbits,
@@ -211,6 +302,39 @@ private:
                                TMORs *orbits,
                                internal::timeout::flag aborted) const;
 
+  bool min_elem_iterate_level(unsigned level,
+                              TaskMapping &representative,
+                              std::vector<TaskMapping> &task_images,
+                              ReprOptions const *options,
+                              TMORs *orbits,
+                              internal::timeout::flag aborted) const;
+
+  void init_automorphisms_chain();
+
+  TaskMapping min_elem_backtrack(TaskMapping const &tasks,
+                                 ReprOptions const *options,
+                                 TMORs *orbits,
+                                 internal::timeout::flag aborted) const;
+
+  bool min_elem_backtrack_level(unsigned level,
+                                TaskMapping const &tasks,
+                                TaskMapping &representative,
+                                std::vector<internal::Perm> &partial_products,
+                                ReprOptions const *options,
+                                TMORs *orbits,
+                                internal::timeout::flag aborted) const;
+
+  std::pair<unsigned, bool> min_elem_backtrack_bound(
+    unsigned level,
+    unsigned x,
+    internal::Perm const &partial_product) const;
+
+  bool min_elem_backtrack_prune(unsigned level,
+                                TaskMapping const &tasks,
+                                TaskMapping const &representative,
+                                internal::Perm const &partial_product,
+                                unsigned offset) const;
+
   TaskMapping min_elem_orbits(TaskMapping const &tasks,
                               ReprOptions const *options,
                               TMORs *orbits,
@@ -219,7 +343,8 @@ private:
   TaskMapping min_elem_local_search(TaskMapping const &tasks,
                                     ReprOptions const *options) const;
 
-  internal::PermSet local_search_augment_gens(ReprOptions const *options) const;
+  internal::PermSet local_search_augment_gens(
+    ReprOptions const *options) const;
 
   TaskMapping min_elem_local_search_sa(TaskMapping const &tasks,
                                        ReprOptions const *options) const;
@@ -235,7 +360,9 @@ private:
                                  ReprOptions const *options) const;
 
   internal::PermGroup _automorphisms;
+  AutomorphismOptions _automorphisms_options;
   internal::PermSet _automorphism_generators;
+  std::vector<internal::SparsePerm> _automorphism_generators_sparse;
 
   bool _automorphisms_valid = false;
 
@@ -244,6 +371,21 @@ private:
 
   unsigned _automorphisms_smp;
   unsigned _automorphisms_lmp;
+
+  // stabilizer chain of the automorphism group, level i holds the transversals
+  // of the i-th base point and their inverses (except on the last level) and
+  // the orbits of the pointwise stabilizer of the first i base points
+  struct ChainLevel
+  {
+    std::vector<internal::Perm> transversals;
+    std::vector<internal::Perm> transversal_inverses;
+    std::vector<int> orbit_indices;
+    std::vector<std::vector<unsigned>> orbits;
+    std::vector<unsigned> orbit_mins;
+  };
+
+  std::vector<ChainLevel> _automorphisms_chain;
+  bool _automorphisms_chain_valid = false;
 };
 
 } // namespace mpsym
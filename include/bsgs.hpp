@@ -2,6 +2,7 @@
 #define GUARD_BSGS_H
 
 #include <cassert>
+#include <cstddef>
 #include <memory>
 #include <ostream>
 #include <stdexcept>
@@ -23,6 +24,7 @@ namespace internal
 
 class Orbit;
 class Perm;
+class PermWord;
 class SchreierStructure;
 
 class BSGSTransversalsBase
@@ -64,6 +66,22 @@ private:
   { return std::make_shared<T>(degree, root, generators); }
 };
 
+class SchreierTreeCache;
+
+class BSGSCachedSchreierTrees : public BSGSTransversalsBase
+{
+public:
+  BSGSCachedSchreierTrees(std::size_t cache_limit);
+
+  virtual ~BSGSCachedSchreierTrees() = default;
+
+private:
+  std::shared_ptr<SchreierStructure> make_schreier_structure(
+    unsigned root, unsigned degree, PermSet const &generators) override;
+
+  std::shared_ptr<SchreierTreeCache> _cache;
+};
+
 struct BSGSOptions;
 
 class BSGS
@@ -119,9 +137,20 @@ public:
   PermSet stabilizers(unsigned i) const;
 
   std::pair<Perm, unsigned> strip(Perm const &perm, unsigned offs = 0) const;
+  std::pair<Perm, unsigned> strip(PermWord const &word, unsigned offs = 0) const;
   bool strips_completely(Perm const &perm) const;
 
+  // binary serialization of degree, base and strong generators, transversals
+  // are not stored but rebuilt from the strong generators on deserialization
+  std::string serialize() const;
+
+  static BSGS deserialize(char const *data,
+                          std::size_t size,
+                          BSGSOptions const *options = nullptr);
+
 private:
+  unsigned strip_images(std::vector<unsigned> &images, unsigned offs) const;
+
   // transversal initialization
   void transversals_init(BSGSOptions const *options);
 
@@ -151,6 +180,11 @@ private:
                             BSGSOptions const *options,
                             timeout::flag aborted);
 
+  bool schreier_sims_random_update(Perm const &strip_perm,
+                                   unsigned strip_level,
+                                   std::vector<PermSet> &strong_generators,
+                                   std::vector<Orbit> &fundamental_orbits);
+
   void schreier_sims_init(PermSet const &generators,
                           std::vector<PermSet> &strong_generators,
                           std::vector<Orbit> &fundamental_orbits);
@@ -235,7 +269,8 @@ struct BSGSOptions
   enum class Transversals {
     EXPLICIT,
     SCHREIER_TREES,
-    SHALLOW_SCHREIER_TREES
+    SHALLOW_SCHREIER_TREES,
+    SCHREIER_VECTOR
   };
 
   static BSGSOptions fill_defaults(BSGSOptions const *options)
@@ -255,6 +290,22 @@ struct BSGSOptions
   BSGS::order_type schreier_sims_random_known_order = 0;
   int schreier_sims_random_retries = -1;
   unsigned schreier_sims_random_w = 100u;
+  // number of threads drawing and stripping random group elements in parallel,
+  // zero uses all available hardware threads
+  unsigned schreier_sims_random_threads = 1u;
+
+  // memory (in bytes) used to cache transversals when using schreier trees,
+  // zero disables caching
+  std::size_t schreier_trees_cache_limit = 0u;
+
+  // directory in which automorphism groups of architecture graphs are
+  // persistently cached (see BSGSCache), empty disables caching
+  std::string automorphisms_cache_directory;
+
+  // number of threads concurrently computing the automorphism groups of the
+  // subsystems of architecture graph clusters, zero uses all available
+  // hardware threads
+  unsigned automorphisms_cluster_threads = 1u;
 };
 
 } // namespace internal
@@ -0,0 +1,43 @@
+#ifndef GUARD_BSGS_CACHE_H
+#define GUARD_BSGS_CACHE_H
+
+#include <string>
+
+#include "bsgs.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+// content addressed on-disk cache of serialized BSGSs, entries are named after
+// a stable hash of some canonical description of the group (e.g. the JSON
+// representation of an architecture graph) and memory mapped when loaded,
+// every entry also stores the full description so that hash collisions are
+// detected on load, entries are written atomically so that a cache directory
+// can be shared by concurrently running processes
+class BSGSCache
+{
+public:
+  explicit BSGSCache(std::string const &directory);
+
+  static std::string key(std::string const &description);
+
+  bool load(std::string const &description,
+            BSGS &bsgs,
+            BSGSOptions const *options = nullptr) const;
+
+  bool store(std::string const &description, BSGS const &bsgs) const;
+
+private:
+  std::string path(std::string const &key) const;
+
+  std::string _directory;
+};
+
+} // namespace internal
+
+} // namespace mpsym
+
+#endif // GUARD_BSGS_CACHE_H
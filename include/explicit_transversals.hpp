@@ -7,6 +7,7 @@
 
 #include "perm.hpp"
 #include "perm_set.hpp"
+#include "perm_word.hpp"
 #include "schreier_structure.hpp"
 
 namespace mpsym
@@ -21,7 +22,7 @@ struct ExplicitTransversals : public SchreierStructure
   : _degree(degree),
     _root(root),
     _labels(labels)
-  { _orbit[root] = Perm(_degree); }
+  { _orbit[root] = PermWord(_degree); }
 
   virtual ~ExplicitTransversals() = default;
 
@@ -39,6 +40,10 @@ struct ExplicitTransversals : public SchreierStructure
   bool contains(unsigned node) const override;
   bool incoming(unsigned node, Perm const &edge) const override;
   Perm transversal(unsigned origin) const override;
+  Perm transversal_inverse(unsigned origin) const override;
+  PermWord transversal_word(unsigned origin) const override;
+  void apply_transversal_inverse(
+    unsigned origin, std::vector<unsigned> &images) const override;
 
 private:
   void dump(std::ostream &os) const override;
@@ -46,7 +51,7 @@ private:
   unsigned _degree;
   unsigned _root;
   PermSet _labels;
-  std::map<unsigned, Perm> _orbit;
+  std::map<unsigned, PermWord> _orbit;
 };
 
 } // namespace internal
@@ -1,7 +1,10 @@
 #ifndef GUARD_HASH_H
 #define GUARD_HASH_H
 
+#include <cstddef>
+#include <cstdint>
 #include <iterator>
+#include <string>
 
 namespace mpsym
 {
@@ -26,6 +29,23 @@ struct ContainerHash
   { return util::container_hash(c.begin(), c.end()); }
 };
 
+// 64 bit FNV-1a, unlike std::hash this is stable across processes and
+// platforms and can thus be used for persistent data
+inline std::uint64_t stable_hash(void const *data, std::size_t size)
+{
+  auto bytes = static_cast<unsigned char const *>(data);
+
+  std::uint64_t hash = 0xcbf29ce484222325ull;
+  for (std::size_t i = 0u; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+inline std::uint64_t stable_hash(std::string const &str)
+{ return stable_hash(str.data(), str.size()); }
+
 } // namespace util
 
 } // namespace mpsym
@@ -0,0 +1,114 @@
+#ifndef GUARD_MAPPED_TASK_MAPPINGS_H
+#define GUARD_MAPPED_TASK_MAPPINGS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "task_mapping.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+// append-only set of equally sized task mappings stored in a memory mapped
+// file, mappings are numbered densely in insertion order and stored as
+// fixed-width rows (see PackedTaskMappings), they are located via an open
+// addressing table of (index, hash fragment) slots so that lookups never need
+// to unpack rows, the file is sized for a fixed capacity when it is created
+// (unused parts of it are never written and thus occupy no disk space on file
+// systems supporting sparse files), insert and contains may be called
+// concurrently, also from different processes mapping the same file
+class MappedTaskMappings
+{
+public:
+  // opens file if it exists and otherwise creates it, mapping_size and
+  // max_task must be compatible with an existing file, capacity is ignored
+  // in that case
+  MappedTaskMappings(std::string const &file,
+                     unsigned mapping_size,
+                     unsigned max_task,
+                     std::size_t capacity);
+
+  ~MappedTaskMappings();
+
+  MappedTaskMappings(MappedTaskMappings const &) = delete;
+  MappedTaskMappings &operator=(MappedTaskMappings const &) = delete;
+
+  std::string const &file() const
+  { return _file; }
+
+  unsigned mapping_size() const;
+  unsigned task_width() const;
+
+  std::size_t size() const;
+  std::size_t capacity() const;
+
+  // throws std::invalid_argument if the mapping has the wrong size or contains
+  // tasks that do not fit the task width and std::length_error if the
+  // capacity is exhausted, insert and contains throw std::runtime_error if
+  // they encounter an insertion by a process that died while inserting
+  std::pair<bool, unsigned> insert(TaskMapping const &mapping);
+
+  bool contains(TaskMapping const &mapping) const;
+
+  // must not be called for indices of mappings which are concurrently being
+  // inserted
+  void get(std::size_t i, TaskMapping &mapping) const;
+
+private:
+  struct Header;
+
+  enum : uint32_t
+  {
+    SLOT_BUSY = 0xffffffffu,
+    SLOT_DEAD = 0xfffffffeu,
+    MAX_CAPACITY = SLOT_DEAD - 1u
+  };
+
+  // slots pack (index + 1) into the upper and a hash fragment into the lower
+  // 32 bits, zero marks an empty slot, slots are marked busy while the row of
+  // a newly inserted mapping is written and dead if that insertion failed
+  static uint64_t slot(uint32_t fragment, uint32_t tag)
+  { return static_cast<uint64_t>(tag) << 32 | fragment; }
+
+  static uint32_t slot_fragment(uint64_t s)
+  { return static_cast<uint32_t>(s); }
+
+  static uint32_t slot_tag(uint64_t s)
+  { return static_cast<uint32_t>(s >> 32); }
+
+  void create(unsigned mapping_size, unsigned max_task, std::size_t capacity);
+  bool open();
+  bool map(int fd, std::size_t size);
+
+  bool pack(TaskMapping const &mapping, unsigned char *row, uint64_t *h) const;
+
+  bool match(uint64_t &s,
+             std::size_t i,
+             uint32_t fragment,
+             unsigned char const *row,
+             unsigned *index) const;
+
+  Header *header() const;
+  std::atomic<uint64_t> *slots() const;
+  unsigned char *row(std::size_t i) const;
+
+  std::string _file;
+
+  void *_data;
+  std::size_t _size;
+
+  std::size_t _row_width;
+  std::size_t _slots_mask;
+};
+
+} // namespace internal
+
+} // namespace mpsym
+
+#endif // GUARD_MAPPED_TASK_MAPPINGS_H
@@ -0,0 +1,174 @@
+#ifndef GUARD_METRICS_H
+#define GUARD_METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#ifdef NMETRICS
+
+#define METRICS_ENABLE()
+#define METRICS_DISABLE()
+#define METRICS_RESET()
+#define METRICS_COUNTER_ADD(name, n)
+#define METRICS_COUNTER_INC(name)
+#define METRICS_LATENCY(name)
+
+#else
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+namespace metrics
+{
+
+// counters and latency histograms are identified by names (which should be
+// valid Prometheus metric name suffixes) and registered on first use, every
+// thread records into its own block of relaxed atomics which are only ever
+// written by that thread, exporting sums up the blocks of all threads
+enum : unsigned
+{
+  MAX_COUNTERS = 64u,
+  MAX_HISTOGRAMS = 32u,
+  // bucket i contains latencies below 2^i nanoseconds, the last bucket
+  // contains all remaining latencies
+  NUM_BUCKETS = 40u
+};
+
+struct ThreadBlock
+{
+  struct Histogram
+  {
+    std::atomic<uint64_t> buckets[NUM_BUCKETS];
+    std::atomic<uint64_t> sum_ns;
+  };
+
+  std::atomic<uint64_t> counters[MAX_COUNTERS];
+  Histogram histograms[MAX_HISTOGRAMS];
+};
+
+extern std::atomic<bool> enabled;
+
+unsigned register_counter(char const *name);
+unsigned register_histogram(char const *name);
+
+ThreadBlock &thread_block_init();
+
+inline ThreadBlock &thread_block()
+{
+  // plain pointer so that accessing it does not require a guard check
+  static thread_local ThreadBlock *block = nullptr;
+
+  if (!block)
+    block = &thread_block_init();
+
+  return *block;
+}
+
+inline void add(std::atomic<uint64_t> &value, uint64_t n)
+{
+  // there is only a single writer, so no read-modify-write is needed
+  value.store(value.load(std::memory_order_relaxed) + n,
+              std::memory_order_relaxed);
+}
+
+inline void counter_add(unsigned counter, uint64_t n)
+{ add(thread_block().counters[counter], n); }
+
+inline unsigned bucket(uint64_t ns)
+{
+  unsigned b = ns == 0u ? 0u : 64u - static_cast<unsigned>(__builtin_clzll(ns));
+
+  return b < NUM_BUCKETS ? b : NUM_BUCKETS - 1u;
+}
+
+inline void histogram_record(unsigned histogram, uint64_t ns)
+{
+  auto &h(thread_block().histograms[histogram]);
+
+  add(h.buckets[bucket(ns)], 1u);
+  add(h.sum_ns, ns);
+}
+
+class ScopedLatency
+{
+  using clock = std::chrono::steady_clock;
+
+public:
+  explicit ScopedLatency(unsigned histogram)
+  : _histogram(histogram),
+    _active(enabled.load(std::memory_order_relaxed))
+  {
+    if (_active)
+      _start = clock::now();
+  }
+
+  ~ScopedLatency()
+  {
+    if (!_active)
+      return;
+
+    auto ns(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      clock::now() - _start).count());
+
+    histogram_record(_histogram, static_cast<uint64_t>(ns));
+  }
+
+  ScopedLatency(ScopedLatency const &) = delete;
+  ScopedLatency &operator=(ScopedLatency const &) = delete;
+
+private:
+  unsigned _histogram;
+  bool _active;
+  clock::time_point _start;
+};
+
+// values recorded since the last reset, latencies are exported in seconds
+std::string to_json();
+std::string to_prometheus();
+
+void reset();
+
+} // namespace metrics
+
+} // namespace internal
+
+} // namespace mpsym
+
+#define METRICS_NS ::mpsym::internal::metrics
+
+#define METRICS_CONCAT_(a, b) a ## b
+#define METRICS_CONCAT(a, b) METRICS_CONCAT_(a, b)
+
+#define METRICS_ENABLE() \
+  do { METRICS_NS :: enabled = true; } while (0)
+#define METRICS_DISABLE() \
+  do { METRICS_NS :: enabled = false; } while (0)
+#define METRICS_RESET() \
+  do { METRICS_NS :: reset(); } while (0)
+
+#define METRICS_COUNTER_ADD(name, n) \
+  do { \
+    if (METRICS_NS :: enabled.load(std::memory_order_relaxed)) { \
+      static unsigned const metrics_counter = \
+        METRICS_NS :: register_counter(name); \
+      METRICS_NS :: counter_add(metrics_counter, n); \
+    } \
+  } while (0)
+
+#define METRICS_COUNTER_INC(name) METRICS_COUNTER_ADD(name, 1u)
+
+// record the latency of the enclosing scope
+#define METRICS_LATENCY(name) \
+  static unsigned const METRICS_CONCAT(metrics_histogram_, __LINE__) = \
+    METRICS_NS :: register_histogram(name); \
+  METRICS_NS :: ScopedLatency METRICS_CONCAT(metrics_latency_, __LINE__)( \
+    METRICS_CONCAT(metrics_histogram_, __LINE__))
+
+#endif
+
+#endif // GUARD_METRICS_H
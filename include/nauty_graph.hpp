@@ -32,6 +32,7 @@ public:
 
   void set_partition(std::vector<std::vector<int>> const &ptn);
 
+  // may be called concurrently for different graphs
   PermSet automorphism_generators();
 
 private:
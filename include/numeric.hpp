@@ -47,6 +47,20 @@ T factorial(T x)
   return res;
 }
 
+inline unsigned log2(unsigned long long x)
+{
+  assert(x > 0u);
+
+#if defined(__GNUC__)
+  return 63u - static_cast<unsigned>(__builtin_clzll(x));
+#else
+  unsigned res = 0u;
+  while (x >>= 1)
+    ++res;
+
+  return res;
+#endif
+}
 
 template<typename T, typename U = double>
 void mean_stddev(std::vector<T> const &vals, U *mean, U *stddev) {
@@ -0,0 +1,370 @@
+#ifndef GUARD_PACKED_TASK_MAPPINGS_H
+#define GUARD_PACKED_TASK_MAPPINGS_H
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "task_mapping.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+// number of bytes needed to store each task of a mapping in a fixed-width row,
+// i.e. the size of the smallest unsigned integer type that can hold max_task
+inline unsigned packed_task_width(unsigned max_task)
+{
+  return max_task <= std::numeric_limits<uint8_t>::max() ? 1u :
+         max_task <= std::numeric_limits<uint16_t>::max() ? 2u : 4u;
+}
+
+template<typename T>
+void pack_task_mapping_(TaskMapping const &mapping, unsigned char *row)
+{
+  for (unsigned i = 0u; i < mapping.size(); ++i) {
+    T task = static_cast<T>(mapping[i]);
+    std::memcpy(row + i * sizeof(T), &task, sizeof(T));
+  }
+}
+
+template<typename T>
+void unpack_task_mapping_(unsigned char const *row, TaskMapping &mapping)
+{
+  for (unsigned i = 0u; i < mapping.size(); ++i) {
+    T task;
+    std::memcpy(&task, row + i * sizeof(T), sizeof(T));
+    mapping[i] = task;
+  }
+}
+
+inline void pack_task_mapping(TaskMapping const &mapping,
+                              unsigned task_width,
+                              unsigned char *row)
+{
+  switch (task_width) {
+  case 1u:
+    pack_task_mapping_<uint8_t>(mapping, row);
+    break;
+  case 2u:
+    pack_task_mapping_<uint16_t>(mapping, row);
+    break;
+  default:
+    pack_task_mapping_<uint32_t>(mapping, row);
+  }
+}
+
+// mapping must already have the correct size
+inline void unpack_task_mapping(unsigned char const *row,
+                                unsigned task_width,
+                                TaskMapping &mapping)
+{
+  switch (task_width) {
+  case 1u:
+    unpack_task_mapping_<uint8_t>(row, mapping);
+    break;
+  case 2u:
+    unpack_task_mapping_<uint16_t>(row, mapping);
+    break;
+  default:
+    unpack_task_mapping_<uint32_t>(row, mapping);
+  }
+}
+
+// sequence of equally sized task mappings stored as fixed-width rows in a
+// single contiguous buffer, tasks are stored using the smallest unsigned
+// integer type that can hold max_task
+class PackedTaskMappings
+{
+public:
+  PackedTaskMappings(unsigned mapping_size, unsigned max_task)
+  : _mapping_size(mapping_size),
+    _task_width(packed_task_width(max_task)),
+    _row_width(_mapping_size * _task_width)
+  {}
+
+  unsigned mapping_size() const
+  { return _mapping_size; }
+
+  unsigned task_width() const
+  { return _task_width; }
+
+  std::size_t size() const
+  { return _size; }
+
+  bool empty() const
+  { return size() == 0u; }
+
+  std::size_t bytes() const
+  { return _data.capacity(); }
+
+  void reserve(std::size_t n)
+  { _data.reserve(n * _row_width); }
+
+  void clear()
+  {
+    _data.clear();
+    _size = 0u;
+  }
+
+  void push_back(TaskMapping const &mapping)
+  {
+    assert(mapping.size() == _mapping_size);
+
+    _data.resize(_data.size() + _row_width);
+    ++_size;
+
+    pack(mapping, &_data[_data.size() - _row_width]);
+  }
+
+  void pop_back()
+  {
+    assert(!empty());
+
+    _data.resize(_data.size() - _row_width);
+    --_size;
+  }
+
+  void get(std::size_t i, TaskMapping &mapping) const
+  {
+    assert(i < size());
+
+    mapping.resize(_mapping_size);
+
+    unpack(&_data[i * _row_width], mapping);
+  }
+
+  void back(TaskMapping &mapping) const
+  { get(size() - 1u, mapping); }
+
+  void append(PackedTaskMappings const &other)
+  {
+    assert(other._mapping_size == _mapping_size);
+    assert(other._task_width == _task_width);
+
+    _data.insert(_data.end(), other._data.begin(), other._data.end());
+    _size += other._size;
+  }
+
+private:
+  void pack(TaskMapping const &mapping, unsigned char *row) const
+  { pack_task_mapping(mapping, _task_width, row); }
+
+  void unpack(unsigned char const *row, TaskMapping &mapping) const
+  { unpack_task_mapping(row, _task_width, mapping); }
+
+  unsigned _mapping_size;
+  unsigned _task_width;
+  unsigned _row_width;
+
+  std::size_t _size = 0u;
+  std::vector<unsigned char> _data;
+};
+
+// perfect hash values are dense, spread them over the table
+inline std::size_t hash_value_slot(uint64_t h, std::size_t mask)
+{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+
+  return static_cast<std::size_t>(h) & mask;
+}
+
+// open addressing (linear probing) set of 64 bit hash values
+class HashValueSet
+{
+public:
+  HashValueSet(std::size_t capacity = 16u)
+  {
+    std::size_t capacity_pow2 = 16u;
+    while (capacity_pow2 < 2u * capacity)
+      capacity_pow2 *= 2u;
+
+    _slots.resize(capacity_pow2, static_cast<uint64_t>(EMPTY));
+  }
+
+  std::size_t size() const
+  { return _size; }
+
+  std::size_t bytes() const
+  { return _slots.capacity() * sizeof(uint64_t); }
+
+  bool contains(uint64_t h) const
+  {
+    h = key(h);
+
+    for (std::size_t i = slot(h);; i = (i + 1u) & mask()) {
+      if (_slots[i] == h)
+        return true;
+      else if (_slots[i] == EMPTY)
+        return false;
+    }
+  }
+
+  // returns true if h was not already contained in the set
+  bool insert(uint64_t h)
+  {
+    if (2u * (_size + 1u) > _slots.size())
+      grow();
+
+    return insert_(key(h));
+  }
+
+private:
+  enum : uint64_t { EMPTY = std::numeric_limits<uint64_t>::max() };
+
+  static uint64_t key(uint64_t h)
+  { return h == EMPTY ? EMPTY - 1u : h; }
+
+  std::size_t mask() const
+  { return _slots.size() - 1u; }
+
+  std::size_t slot(uint64_t h) const
+  { return hash_value_slot(h, mask()); }
+
+  bool insert_(uint64_t h)
+  {
+    for (std::size_t i = slot(h);; i = (i + 1u) & mask()) {
+      if (_slots[i] == h)
+        return false;
+
+      if (_slots[i] == EMPTY) {
+        _slots[i] = h;
+        ++_size;
+        return true;
+      }
+    }
+  }
+
+  void grow()
+  {
+    std::vector<uint64_t> slots(2u * _slots.size(),
+                                static_cast<uint64_t>(EMPTY));
+    std::swap(slots, _slots);
+
+    _size = 0u;
+    for (uint64_t h : slots) {
+      if (h != EMPTY)
+        insert_(h);
+    }
+  }
+
+  std::size_t _size = 0u;
+  std::vector<uint64_t> _slots;
+};
+
+// like HashValueSet but insert and contains may be called concurrently, the
+// table does not grow by itself, instead reserve must be called beforehand
+// (and not concurrently with any other member function) such that the number
+// of elements never exceeds the reserved number
+class ConcurrentHashValueSet
+{
+public:
+  ConcurrentHashValueSet(std::size_t capacity = 16u)
+  { reserve(capacity); }
+
+  std::size_t size() const
+  { return _size.load(); }
+
+  std::size_t bytes() const
+  { return _capacity * sizeof(uint64_t); }
+
+  void reserve(std::size_t n)
+  {
+    std::size_t capacity = _capacity > 0u ? _capacity : 16u;
+    while (capacity < 2u * n)
+      capacity *= 2u;
+
+    if (capacity == _capacity)
+      return;
+
+    std::unique_ptr<std::atomic<uint64_t>[]> slots(
+      new std::atomic<uint64_t>[capacity]);
+
+    for (std::size_t i = 0u; i < capacity; ++i)
+      slots[i].store(EMPTY, std::memory_order_relaxed);
+
+    std::swap(slots, _slots);
+    std::swap(capacity, _capacity);
+
+    for (std::size_t i = 0u; i < capacity; ++i) {
+      uint64_t h = slots[i].load(std::memory_order_relaxed);
+      if (h != EMPTY)
+        insert_(h);
+    }
+  }
+
+  bool contains(uint64_t h) const
+  {
+    h = key(h);
+
+    for (std::size_t i = slot(h);; i = (i + 1u) & mask()) {
+      uint64_t h_slot = _slots[i].load(std::memory_order_relaxed);
+
+      if (h_slot == h)
+        return true;
+      else if (h_slot == EMPTY)
+        return false;
+    }
+  }
+
+  // returns true if h was not already contained in the set, if several
+  // threads insert the same value concurrently exactly one of them succeeds
+  bool insert(uint64_t h)
+  {
+    assert(2u * (size() + 1u) <= _capacity);
+
+    if (!insert_(key(h)))
+      return false;
+
+    _size.fetch_add(1u, std::memory_order_relaxed);
+    return true;
+  }
+
+private:
+  enum : uint64_t { EMPTY = std::numeric_limits<uint64_t>::max() };
+
+  static uint64_t key(uint64_t h)
+  { return h == EMPTY ? EMPTY - 1u : h; }
+
+  std::size_t mask() const
+  { return _capacity - 1u; }
+
+  std::size_t slot(uint64_t h) const
+  { return hash_value_slot(h, mask()); }
+
+  bool insert_(uint64_t h)
+  {
+    for (std::size_t i = slot(h);; i = (i + 1u) & mask()) {
+      uint64_t h_slot = _slots[i].load(std::memory_order_relaxed);
+
+      if (h_slot == EMPTY) {
+        if (_slots[i].compare_exchange_strong(h_slot, h,
+                                              std::memory_order_relaxed))
+          return true;
+      }
+
+      if (h_slot == h)
+        return false;
+    }
+  }
+
+  std::size_t _capacity = 0u;
+  std::atomic<std::size_t> _size{0u};
+  std::unique_ptr<std::atomic<uint64_t>[]> _slots;
+};
+
+} // namespace internal
+
+} // namespace mpsym
+
+#endif // GUARD_PACKED_TASK_MAPPINGS_H
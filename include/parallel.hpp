@@ -0,0 +1,99 @@
+#ifndef GUARD_PARALLEL_H
+#define GUARD_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mpsym
+{
+
+namespace util
+{
+
+inline unsigned num_threads(unsigned requested = 0u)
+{
+  if (requested > 0u)
+    return requested;
+
+  unsigned hardware = std::thread::hardware_concurrency();
+
+  return hardware > 0u ? hardware : 1u;
+}
+
+// call func(i) for every i in [0, n), spread over (at most) num_threads threads
+// which pick up chunks of consecutive indices on demand, the calling thread
+// takes part in the work and the first exception thrown by any worker is
+// rethrown once all workers have finished
+template<typename FUNC>
+void parallel_for(std::size_t n,
+                  unsigned num_threads,
+                  FUNC &&func,
+                  std::size_t chunk_size = 0u)
+{
+  if (n == 0u)
+    return;
+
+  num_threads = std::min<std::size_t>(util::num_threads(num_threads), n);
+
+  if (num_threads == 1u) {
+    for (std::size_t i = 0u; i < n; ++i)
+      func(i);
+
+    return;
+  }
+
+  if (chunk_size == 0u)
+    chunk_size = std::max<std::size_t>(1u, n / (8u * num_threads));
+
+  std::atomic<std::size_t> next(0u);
+  std::atomic<bool> failed(false);
+
+  std::exception_ptr exception;
+  std::mutex exception_mutex;
+
+  auto worker = [&]{
+    try {
+      while (!failed.load(std::memory_order_relaxed)) {
+        std::size_t first = next.fetch_add(chunk_size);
+        if (first >= n)
+          break;
+
+        std::size_t last = std::min(first + chunk_size, n);
+        for (std::size_t i = first; i < last; ++i)
+          func(i);
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(exception_mutex);
+
+      if (!exception)
+        exception = std::current_exception();
+
+      failed = true;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1u);
+
+  for (unsigned i = 1u; i < num_threads; ++i)
+    threads.emplace_back(worker);
+
+  worker();
+
+  for (auto &thread : threads)
+    thread.join();
+
+  if (exception)
+    std::rethrow_exception(exception);
+}
+
+} // namespace util
+
+} // namespace mpsym
+
+#endif // GUARD_PARALLEL_H
@@ -2,7 +2,9 @@
 #define GUARD_PERM_H
 
 #include <algorithm>
+#include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <ostream>
 #include <vector>
 
@@ -48,13 +50,54 @@ public:
 
   Perm(unsigned degree, std::vector<std::vector<unsigned>> const &cycles);
 
-  unsigned const& operator[](unsigned const x) const;
+  Perm(Perm const &other);
+  Perm(Perm &&other) noexcept;
+
+  ~Perm();
+
+  Perm &operator=(Perm const &other);
+  Perm &operator=(Perm &&other) noexcept;
+
+  unsigned operator[](unsigned x) const
+  {
+    assert(x < degree());
+
+    switch (_width) {
+      case 1u:
+        return data<uint8_t>()[x];
+      case 2u:
+        return data<uint16_t>()[x];
+      default:
+        return data<uint32_t>()[x];
+    }
+  }
+
   Perm operator~() const;
   bool operator==(Perm const &rhs) const;
   bool operator<(Perm const &rhs) const;
   Perm& operator*=(Perm const &rhs);
 
   unsigned degree() const { return _degree; }
+
+  // number of bytes used to store each point image, this is the smallest
+  // of 1, 2 and 4 that can represent all points
+  unsigned width() const { return _width; }
+
+  // width of permutations of the given degree
+  static unsigned width(unsigned degree)
+  {
+    assert(degree > 0u);
+
+    return degree - 1u <= UINT8_MAX ? 1u : degree - 1u <= UINT16_MAX ? 2u : 4u;
+  }
+
+  template<typename T>
+  T const *data() const
+  {
+    assert(sizeof(T) == _width);
+    return reinterpret_cast<T const *>(storage());
+  }
+
   bool id() const;
   bool even() const;
 
@@ -98,14 +141,47 @@ public:
     return Perm(degree(), restricted_cycles);
   }
 
-  std::vector<unsigned> vect() const
-  { return std::vector<unsigned>(_perm.begin(), _perm.end()); }
+  std::vector<unsigned> vect() const;
 
   std::vector<std::vector<unsigned>> cycles() const;
 
 private:
+  // permutations whose images fit into this many bytes are stored inline,
+  // i.e. without allocating, with 1 byte per image this covers degree <= 64
+  enum : unsigned { INLINE_BYTES = 64u };
+
+  void allocate(unsigned degree);
+  void deallocate();
+
+  void set(unsigned x, unsigned y);
+
+  std::size_t bytes() const
+  { return static_cast<std::size_t>(_degree) * _width; }
+
+  bool inlined() const
+  { return bytes() <= INLINE_BYTES; }
+
+  unsigned char *storage()
+  { return inlined() ? _storage.local : _storage.heap; }
+
+  unsigned char const *storage() const
+  { return inlined() ? _storage.local : _storage.heap; }
+
+  template<typename T>
+  T *mutable_data()
+  {
+    assert(sizeof(T) == _width);
+    return reinterpret_cast<T *>(storage());
+  }
+
   unsigned _degree;
-  std::vector<unsigned> _perm;
+  unsigned _width;
+
+  union
+  {
+    unsigned char local[INLINE_BYTES];
+    unsigned char *heap;
+  } _storage;
 };
 
 std::ostream &operator<<(std::ostream &os, Perm const &perm);
@@ -54,9 +54,21 @@ public:
     bool _end;
 
     std::vector<PermSet> _transversals;
-    Perm _current;
-    bool _current_valid;
     PermSet _current_factors;
+
+    // _partial_products[i] is the product of the current factors on levels
+    // i and above, only the products on the _partial_products_stale lowest
+    // levels need to be recomputed after the iterator has been advanced
+    std::vector<Perm> _partial_products;
+    unsigned _partial_products_stale;
+  };
+
+  // return values of visitors passed to visit()
+  enum class Visit
+  {
+    CONTINUE,
+    SKIP_SUBTREE,
+    STOP
   };
 
   explicit PermGroup(unsigned degree = 1)
@@ -79,11 +91,13 @@ public:
   static PermGroup cyclic(unsigned degree);
   static PermGroup dihedral(unsigned degree);
 
+  // the base and strong generating set of the direct product are assembled
+  // from those of the factors, no Schreier-Sims is necessary
   template<typename IT>
   static PermGroup direct_product(IT first,
                                   IT last,
-                                  BSGSOptions const *bsgs_options_ = nullptr,
-                                  timeout::flag aborted = timeout::unset())
+                                  BSGSOptions const *bsgs_options = nullptr,
+                                  timeout::flag = timeout::unset())
   {
     assert(std::distance(first, last) > 0);
 
@@ -93,25 +107,28 @@ public:
     for (auto it = first; it != last; ++it)
       dp_degree += it->degree();
 
-    // direct product order
-    auto dp_order(direct_product_order(first, last));
-
-    // direct product generators
+    // direct product base and strong generators
     unsigned d = 0u;
 
-    PermSet dp_generators;
+    BSGS::Base dp_base;
+    PermSet dp_strong_generators;
+
     for (auto it = first; it != last; ++it) {
-      for (Perm const &perm : it->generators())
-        dp_generators.insert(perm.shifted(d).extended(dp_degree));
+      for (unsigned b : it->bsgs().base())
+        dp_base.push_back(b + d);
+
+      for (Perm const &perm : it->bsgs().strong_generators())
+        dp_strong_generators.insert(perm.shifted(d).extended(dp_degree));
 
       d += it->degree();
     }
 
-    // construct direct product
-    auto bsgs_options(BSGSOptions::fill_defaults(bsgs_options_));
-    bsgs_options.schreier_sims_random_known_order = dp_order;
+    if (dp_base.empty())
+      return PermGroup(dp_degree);
 
-    return PermGroup(BSGS(dp_degree, dp_generators, &bsgs_options, aborted));
+    // construct direct product
+    return PermGroup(
+      BSGS(dp_degree, dp_base, dp_strong_generators, bsgs_options));
   }
 
   template<typename IT>
@@ -142,6 +159,24 @@ public:
   const_iterator begin() const { return const_iterator(*this); }
   const_iterator end() const { return const_iterator(); }
 
+  // depth first traversal of the stabilizer chain, visitor(level, partial) is
+  // called with the product of the transversal elements chosen on the first
+  // `level` levels, for level == bsgs().base_size() these are exactly the
+  // group elements, returning Visit::SKIP_SUBTREE skips all elements with
+  // the given prefix, returns false if the visitor returned Visit::STOP
+  template<typename VISITOR>
+  bool visit(VISITOR &&visitor) const
+  {
+    std::vector<PermSet> transversals;
+    for (unsigned i = 0u; i < _bsgs.base_size(); ++i)
+      transversals.push_back(_bsgs.transversals(i));
+
+    std::vector<Perm> partial_products(transversals.size() + 1u,
+                                       Perm(degree()));
+
+    return visit_level(0u, transversals, partial_products, visitor);
+  }
+
   PermSet generators() const { return _bsgs.strong_generators(); }
 
   BSGS &bsgs() { return _bsgs; }
@@ -167,8 +202,21 @@ public:
   bool contains_element(Perm const &perm) const;
   Perm random_element() const;
 
+  // subgroup mapping the set {x, y} onto itself (x may be equal to y), this
+  // only requires a base change of (a copy of) the group's BSGS, the result's
+  // transversals are constructed according to bsgs_options
+  PermGroup setwise_stabilizer(
+    unsigned x,
+    unsigned y,
+    BSGSOptions const *bsgs_options = nullptr) const;
+
+  // num_threads is the number of threads testing candidate decompositions
+  // in parallel (only relevant if complete is true), zero uses all available
+  // hardware threads
   std::vector<PermGroup> disjoint_decomposition(
-    bool complete = true, bool disjoint_orbit_optimization = false) const;
+    bool complete = true,
+    bool disjoint_orbit_optimization = false,
+    unsigned num_threads = 1u) const;
 
   std::vector<PermGroup> wreath_decomposition() const;
 
@@ -182,6 +230,37 @@ private:
     return ret;
   }
 
+  // group traversal
+  template<typename VISITOR>
+  static bool visit_level(unsigned level,
+                          std::vector<PermSet> const &transversals,
+                          std::vector<Perm> &partial_products,
+                          VISITOR &visitor)
+  {
+    switch (visitor(level, partial_products[level])) {
+      case Visit::CONTINUE:
+        break;
+      case Visit::SKIP_SUBTREE:
+        return true;
+      case Visit::STOP:
+        return false;
+    }
+
+    if (level == transversals.size())
+      return true;
+
+    // copy assignment reuses the storage of the next level's partial product
+    for (Perm const &transversal : transversals[level]) {
+      partial_products[level + 1u] = transversal;
+      partial_products[level + 1u] *= partial_products[level];
+
+      if (!visit_level(level + 1u, transversals, partial_products, visitor))
+        return false;
+    }
+
+    return true;
+  }
+
   // complete disjoint decomposition
   bool disjoint_decomp_orbits_dependent(
     Orbit const &orbit1,
@@ -190,21 +269,23 @@ private:
   void disjoint_decomp_generate_dependency_classes(
     OrbitPartition &orbits) const;
 
-  static bool disjoint_decomp_restricted_subgroups(
-    OrbitPartition const &orbit_split,
-    PermGroup const &perm_group,
-    std::pair<PermGroup, PermGroup> &restricted_subgroups);
+  Perm disjoint_decomp_restricted_generator(
+    Perm const &gen,
+    std::vector<unsigned> const &split,
+    std::vector<std::vector<unsigned>> const &orbit_points) const;
 
-  static std::vector<PermGroup> disjoint_decomp_join_results(
-    std::vector<PermGroup> const &res1,
-    std::vector<PermGroup> const &res2);
+  bool disjoint_decomp_splits(
+    std::vector<unsigned> const &split,
+    std::vector<std::vector<unsigned>> const &orbit_points) const;
 
-  static std::vector<PermGroup> disjoint_decomp_complete_recursive(
-    OrbitPartition const &orbits,
-    PermGroup const &perm_group);
+  std::vector<unsigned> disjoint_decomp_minimal_split(
+    std::vector<unsigned> const &orbits,
+    std::vector<std::vector<unsigned>> const &orbit_points,
+    unsigned num_threads) const;
 
   std::vector<PermGroup> disjoint_decomp_complete(
-    bool disjoint_orbit_optimization = true) const;
+    bool disjoint_orbit_optimization,
+    unsigned num_threads) const;
 
   // incomplete disjoint decomposition
   struct MovedSet : public std::vector<unsigned>
@@ -0,0 +1,50 @@
+#ifndef GUARD_PERM_KERNELS_H
+#define GUARD_PERM_KERNELS_H
+
+#include <cstdint>
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+// implementations of the permutation kernels below, AVX2 and AVX512 are only
+// available on x86 CPUs which support the respective instruction set
+// extensions, SIMD variants fall back to scalar code for element types and
+// degrees they do not handle
+enum class PermKernelVariant
+{
+  SCALAR,
+  AVX2,
+  AVX512
+};
+
+bool perm_kernel_variant_supported(PermKernelVariant variant);
+
+// best variant supported by the executing CPU, determined once at runtime
+PermKernelVariant perm_kernel_variant();
+
+char const *perm_kernel_variant_name(PermKernelVariant variant);
+
+// the kernels below are defined for T in {uint8_t, uint16_t, uint32_t}
+
+// lhs[x] = rhs[lhs[x]] for all x < degree, i.e. lhs *= rhs
+template<typename T>
+void perm_compose(T *lhs,
+                  T const *rhs,
+                  unsigned degree,
+                  PermKernelVariant variant = perm_kernel_variant());
+
+// inverse[perm[x]] = x for all x < degree
+template<typename T>
+void perm_invert(T const *perm,
+                 T *inverse,
+                 unsigned degree,
+                 PermKernelVariant variant = perm_kernel_variant());
+
+} // namespace internal
+
+} // namespace mpsym
+
+#endif // GUARD_PERM_KERNELS_H
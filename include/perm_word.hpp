@@ -0,0 +1,111 @@
+#ifndef GUARD_PERM_WORD_H
+#define GUARD_PERM_WORD_H
+
+#include <atomic>
+#include <memory>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include <boost/operators.hpp>
+
+#include "perm.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+// product of permutations which is not multiplied out, factors are shared
+// between copies and their inverses are only computed when first needed,
+// point images cost O(length) instead of O(degree) per multiplication
+class PermWord : boost::multipliable<PermWord>
+{
+  class Factor
+  {
+  public:
+    Factor(Perm const &perm)
+    : _images(perm.vect()),
+      _inverse_images(nullptr)
+    {}
+
+    ~Factor()
+    { delete[] _inverse_images.load(); }
+
+    unsigned const *images() const
+    { return _images.data(); }
+
+    unsigned const *inverse_images() const
+    {
+      unsigned const *inverse_images =
+        _inverse_images.load(std::memory_order_acquire);
+
+      if (!inverse_images) {
+        unsigned *inverse_images_new = new unsigned[_images.size()];
+
+        for (unsigned x = 0u; x < _images.size(); ++x)
+          inverse_images_new[_images[x]] = x;
+
+        if (_inverse_images.compare_exchange_strong(inverse_images,
+                                                    inverse_images_new)) {
+          inverse_images = inverse_images_new;
+        } else {
+          delete[] inverse_images_new;
+        }
+      }
+
+      return inverse_images;
+    }
+
+  private:
+    std::vector<unsigned> _images;
+    mutable std::atomic<unsigned const *> _inverse_images;
+  };
+
+public:
+  explicit PermWord(unsigned degree = 1);
+  explicit PermWord(Perm const &perm);
+
+  unsigned operator[](unsigned x) const;
+  PermWord operator~() const;
+  PermWord& operator*=(PermWord const &rhs);
+
+  unsigned degree() const
+  { return _degree; }
+
+  unsigned length() const
+  { return _factors.size(); }
+
+  bool id() const;
+
+  Perm perm() const;
+
+  // multiply the permutation given by images by this word (or its inverse)
+  // in place, i.e. replace every images[x] by its image under the word
+  void apply(std::vector<unsigned> &images) const;
+  void apply_inverse(std::vector<unsigned> &images) const;
+
+private:
+  // second element is true if the inverse of the factor is meant
+  using factor_type = std::pair<std::shared_ptr<Factor const>, bool>;
+
+  std::vector<unsigned> const &images() const;
+
+  static unsigned const *factor_images(factor_type const &factor)
+  {
+    return factor.second ? factor.first->inverse_images()
+                         : factor.first->images();
+  }
+
+  unsigned _degree;
+  std::vector<factor_type> _factors;
+};
+
+std::ostream &operator<<(std::ostream &os, PermWord const &pw);
+
+} // namespace internal
+
+} // namespace mpsym
+
+#endif // GUARD_PERM_WORD_H
@@ -1,6 +1,8 @@
 #ifndef GUARD_PR_RANDOMIZER_H
 #define GUARD_PR_RANDOMIZER_H
 
+#include <random>
+
 #include "perm_set.hpp"
 
 namespace mpsym
@@ -11,6 +13,8 @@ namespace internal
 
 class Perm;
 
+// every instance owns its random engine, distinct instances can thus be used
+// concurrently to obtain independent streams of random group elements
 class PrRandomizer
 {
 public:
@@ -28,6 +32,8 @@ private:
 
   PermSet _gens_orig;
   PermSet _gens;
+
+  std::mt19937 _re;
 };
 
 } // namespace internal
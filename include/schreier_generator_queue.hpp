@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "perm.hpp"
+#include "perm_word.hpp"
 #include "schreier_structure.hpp"
 #include "util.hpp"
 
@@ -24,10 +25,10 @@ class SchreierGeneratorQueue
   using fo_it_type = fo_type::const_iterator;
 
 public:
-  using value_type = Perm;
-  using const_reference = Perm const &;
+  using value_type = PermWord;
+  using const_reference = PermWord const &;
 
-  class const_iterator : public util::Iterator<const_iterator, Perm const>
+  class const_iterator : public util::Iterator<const_iterator, PermWord const>
   {
   public:
     const_iterator()
@@ -75,6 +76,10 @@ public:
     _sg_begin = _sg_it;
     _sg_end = strong_generators.end();
 
+    _sg_words.clear();
+    for (Perm const &sg : strong_generators)
+      _sg_words.emplace_back(sg);
+
     _beta_it = fundamental_orbit.begin();
     _beta_end = fundamental_orbit.end();
 
@@ -93,11 +98,14 @@ public:
   const_iterator end() { return const_iterator(); }
 
 private:
-  Perm u_beta()
-  { return _schreier_structure->transversal(*_beta_it); }
+  PermWord u_beta()
+  { return _schreier_structure->transversal_word(*_beta_it); }
+
+  PermWord u_beta_x()
+  { return _schreier_structure->transversal_word((*_sg_it)[*_beta_it]); }
 
-  Perm u_beta_x()
-  { return _schreier_structure->transversal((*_sg_it)[*_beta_it]); }
+  PermWord const &sg_word()
+  { return _sg_words[_sg_it - _sg_begin]; }
 
   void next_sg()
   {
@@ -126,7 +134,7 @@ private:
     if (_exhausted)
       return;
 
-    _schreier_generator = _u_beta * (*_sg_it) * ~u_beta_x();
+    _schreier_generator = _u_beta * sg_word() * ~u_beta_x();
   }
 
   void mark_used() { _used = true; }
@@ -144,8 +152,10 @@ private:
   bool _used;
   bool _exhausted;
 
-  Perm _u_beta;
-  Perm _schreier_generator;
+  std::vector<PermWord> _sg_words;
+
+  PermWord _u_beta;
+  PermWord _schreier_generator;
 };
 
 } // namespace internal
@@ -12,6 +12,7 @@ namespace internal
 
 class Perm;
 class PermSet;
+class PermWord;
 class SchreierStructure;
 
 class SchreierStructure
@@ -34,6 +35,13 @@ public:
   virtual bool contains(unsigned node) const = 0;
   virtual bool incoming(unsigned node, Perm const &edge) const = 0;
   virtual Perm transversal(unsigned origin) const = 0;
+  virtual Perm transversal_inverse(unsigned origin) const = 0;
+  virtual PermWord transversal_word(unsigned origin) const = 0;
+
+  // multiply the permutation given by images by the inverse transversal of
+  // origin in place, without constructing that inverse if possible
+  virtual void apply_transversal_inverse(
+    unsigned origin, std::vector<unsigned> &images) const = 0;
 
 private:
   virtual void dump(std::ostream& os) const = 0;
@@ -1,12 +1,20 @@
 #ifndef GUARD_SCHREIER_TREE_H
 #define GUARD_SCHREIER_TREE_H
 
+#include <cstddef>
+#include <cstdint>
+#include <list>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <ostream>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "perm.hpp"
 #include "perm_set.hpp"
+#include "perm_word.hpp"
 #include "schreier_structure.hpp"
 
 namespace mpsym
@@ -15,18 +23,66 @@ namespace mpsym
 namespace internal
 {
 
+// bounded least recently used cache of transversals which can be shared
+// between the schreier trees of a BSGS, limit is given in bytes
+class SchreierTreeCache
+{
+public:
+  SchreierTreeCache(std::size_t limit)
+  : _limit(limit)
+  {}
+
+  std::size_t limit() const
+  { return _limit; }
+
+  std::size_t size() const;
+
+  bool find(unsigned tree, unsigned node, Perm *transversal);
+  void insert(unsigned tree, unsigned node, Perm const &transversal);
+
+  static unsigned next_tree();
+
+private:
+  using key_type = uint64_t;
+  using entry_type = std::pair<key_type, Perm>;
+
+  static key_type key(unsigned tree, unsigned node)
+  { return static_cast<key_type>(tree) << 32 | node; }
+
+  static std::size_t entry_size(Perm const &transversal)
+  { return sizeof(entry_type) + transversal.degree() * transversal.width(); }
+
+  std::size_t _limit;
+  std::size_t _size = 0u;
+
+  std::list<entry_type> _entries;
+  std::unordered_map<key_type, std::list<entry_type>::iterator> _index;
+
+  mutable std::mutex _mutex;
+};
+
 struct SchreierTree : public SchreierStructure
 {
-  SchreierTree(unsigned degree, unsigned root, PermSet const &labels)
+  SchreierTree(unsigned degree,
+               unsigned root,
+               PermSet const &labels,
+               std::shared_ptr<SchreierTreeCache> cache = nullptr)
   : _degree(degree),
     _root(root),
-    _labels(labels)
-  {}
+    _cache(cache),
+    _cache_tree(cache ? SchreierTreeCache::next_tree() : 0u)
+  {
+    for (Perm const &label : labels)
+      add_label(label);
+  }
 
   virtual ~SchreierTree() = default;
 
   void add_label(Perm const &label) override
-  { _labels.insert(label); }
+  {
+    _labels.insert(label);
+    _label_words.emplace_back(label);
+  }
 
   void create_edge(unsigned origin,
                    unsigned destination,
@@ -39,6 +95,10 @@ struct SchreierTree : public SchreierStructure
   bool contains(unsigned node) const override;
   bool incoming(unsigned node, Perm const &edge) const override;
   Perm transversal(unsigned origin) const override;
+  Perm transversal_inverse(unsigned origin) const override;
+  PermWord transversal_word(unsigned origin) const override;
+  void apply_transversal_inverse(
+    unsigned origin, std::vector<unsigned> &images) const override;
 
 private:
   void dump(std::ostream &os) const override;
@@ -47,7 +107,11 @@ private:
   unsigned _root;
   std::map<unsigned, unsigned> _edges;
   PermSet _labels;
+  std::vector<PermWord> _label_words;
   std::map<unsigned, unsigned> _edge_labels;
+
+  std::shared_ptr<SchreierTreeCache> _cache;
+  unsigned _cache_tree;
 };
 
 } // namespace internal
@@ -0,0 +1,68 @@
+#ifndef GUARD_SCHREIER_VECTOR_H
+#define GUARD_SCHREIER_VECTOR_H
+
+#include <ostream>
+#include <vector>
+
+#include "perm.hpp"
+#include "perm_set.hpp"
+#include "perm_word.hpp"
+#include "schreier_structure.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+// schreier tree stored as a vector that maps every point to the index of the
+// label of its incoming edge, the inverses of all labels are stored as images
+// in one contiguous array, the parent of a node is obtained by applying the
+// inverse of its incoming edge's label to it
+struct SchreierVector : public SchreierStructure
+{
+  SchreierVector(unsigned degree, unsigned root, PermSet const &labels);
+
+  virtual ~SchreierVector() = default;
+
+  void add_label(Perm const &label) override;
+
+  void create_edge(unsigned origin,
+                   unsigned destination,
+                   unsigned label) override;
+
+  unsigned root() const override;
+  std::vector<unsigned> nodes() const override;
+  PermSet labels() const override;
+
+  bool contains(unsigned node) const override;
+  bool incoming(unsigned node, Perm const &edge) const override;
+  Perm transversal(unsigned origin) const override;
+  Perm transversal_inverse(unsigned origin) const override;
+  PermWord transversal_word(unsigned origin) const override;
+  void apply_transversal_inverse(
+    unsigned origin, std::vector<unsigned> &images) const override;
+
+private:
+  enum : int { NOT_CONTAINED = -1, ROOT = -2 };
+
+  unsigned const *label_inverse(unsigned i) const
+  { return &_label_inverse_images[i * _degree]; }
+
+  unsigned const *transversal_inverse_images(unsigned origin) const;
+
+  void dump(std::ostream &os) const override;
+
+  unsigned _degree;
+  unsigned _root;
+  unsigned _num_labels;
+  std::vector<int> _vector;
+  std::vector<unsigned> _nodes;
+  std::vector<unsigned> _label_inverse_images;
+};
+
+} // namespace internal
+
+} // namespace mpsym
+
+#endif // GUARD_SCHREIER_VECTOR_H
@@ -0,0 +1,77 @@
+#ifndef GUARD_SPARSE_PERM_H
+#define GUARD_SPARSE_PERM_H
+
+#include <cassert>
+#include <vector>
+
+#include "perm.hpp"
+#include "perm_set.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+// permutation stored as its support (in ascending order) and the images of
+// the points in its support, cheap to apply if the support is small compared
+// to the degree
+class SparsePerm
+{
+public:
+  explicit SparsePerm(Perm const &perm)
+  : _degree(perm.degree())
+  {
+    for (unsigned x = 0u; x < perm.degree(); ++x) {
+      unsigned y = perm[x];
+
+      if (y != x) {
+        _support.push_back(x);
+        _images.push_back(y);
+      }
+    }
+  }
+
+  unsigned degree() const
+  { return _degree; }
+
+  unsigned support_size() const
+  { return static_cast<unsigned>(_support.size()); }
+
+  bool id() const
+  { return _support.empty(); }
+
+  unsigned support(unsigned i) const
+  {
+    assert(i < support_size());
+    return _support[i];
+  }
+
+  unsigned image(unsigned i) const
+  {
+    assert(i < support_size());
+    return _images[i];
+  }
+
+private:
+  unsigned _degree;
+  std::vector<unsigned> _support;
+  std::vector<unsigned> _images;
+};
+
+inline std::vector<SparsePerm> sparse_perms(PermSet const &perms)
+{
+  std::vector<SparsePerm> res;
+  res.reserve(perms.size());
+
+  for (auto const &perm : perms)
+    res.emplace_back(perm);
+
+  return res;
+}
+
+} // namespace internal
+
+} // namespace mpsym
+
+#endif // GUARD_SPARSE_PERM_H
@@ -1,7 +1,9 @@
 #ifndef GUARD_TASK_MAPPING_H
 #define GUARD_TASK_MAPPING_H
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <initializer_list>
 #include <ostream>
 #include <type_traits>
@@ -10,11 +12,149 @@
 
 #include "dump.hpp"
 #include "perm.hpp"
+#include "sparse_perm.hpp"
 #include "util.hpp"
 
 namespace mpsym
 {
 
+namespace internal
+{
+
+// positions at which each task in [offset, offset + degree) occurs in a task
+// mapping, only the tasks actually occurring in the mapping are indexed so that
+// (re)building an index takes O(k log k) time for a mapping of k tasks
+// independent of the degree, positions are stored grouped by task in ascending
+// order and tasks are mapped to these groups indirectly so that the index can
+// be updated in O((|support(perm)| + k) log k) after the mapping is permuted
+// by perm
+class TaskMappingIndex
+{
+public:
+  TaskMappingIndex()
+  : _degree(0u)
+  {}
+
+  TaskMappingIndex(std::vector<unsigned> const &mapping,
+                   unsigned offset,
+                   unsigned degree)
+  { reset(mapping, offset, degree); }
+
+  // index mapping instead, reusing the storage of the current index
+  void reset(std::vector<unsigned> const &mapping,
+             unsigned offset,
+             unsigned degree)
+  {
+    _degree = degree;
+
+    _groups.clear();
+    _group_offsets.clear();
+    _positions.clear();
+
+    // (task, position) pairs in ascending order
+    _buffer.clear();
+
+    for (unsigned i = 0u; i < mapping.size(); ++i) {
+      unsigned task = mapping[i];
+
+      if (task >= offset && task < offset + degree)
+        _buffer.emplace_back(task - offset, i);
+    }
+
+    std::sort(_buffer.begin(), _buffer.end());
+
+    for (auto const &entry : _buffer) {
+      if (_groups.empty() || _groups.back().first != entry.first) {
+        _groups.emplace_back(entry.first,
+                             static_cast<unsigned>(_group_offsets.size()));
+
+        _group_offsets.push_back(static_cast<unsigned>(_positions.size()));
+      }
+
+      _positions.push_back(entry.second);
+    }
+
+    _group_offsets.push_back(static_cast<unsigned>(_positions.size()));
+  }
+
+  unsigned degree() const
+  { return _degree; }
+
+  // task is relative to offset, returns an empty range if it does not occur
+  std::pair<unsigned const *, unsigned const *> positions(unsigned task) const
+  {
+    assert(task < degree());
+
+    auto it(find(task));
+    if (it == _groups.end())
+      return {nullptr, nullptr};
+
+    return {_positions.data() + _group_offsets[it->second],
+            _positions.data() + _group_offsets[it->second + 1u]};
+  }
+
+  bool contains(unsigned task) const
+  {
+    auto range(positions(task));
+    return range.first != range.second;
+  }
+
+  unsigned const *positions_begin(unsigned task) const
+  { return positions(task).first; }
+
+  unsigned const *positions_end(unsigned task) const
+  { return positions(task).second; }
+
+  // update the index after the indexed mapping has been permuted by perm
+  void permute(SparsePerm const &perm)
+  {
+    assert(perm.degree() == degree());
+
+    // look up all moved tasks before renaming any of them
+    _buffer.clear();
+
+    for (unsigned i = 0u; i < perm.support_size(); ++i) {
+      auto it(find(perm.support(i)));
+
+      if (it != _groups.end()) {
+        _buffer.emplace_back(static_cast<unsigned>(it - _groups.begin()),
+                             perm.image(i));
+      }
+    }
+
+    if (_buffer.empty())
+      return;
+
+    for (auto const &moved : _buffer)
+      _groups[moved.first].first = moved.second;
+
+    std::sort(_groups.begin(), _groups.end());
+  }
+
+private:
+  using group_list = std::vector<std::pair<unsigned, unsigned>>;
+
+  group_list::const_iterator find(unsigned task) const
+  {
+    auto it(std::lower_bound(_groups.begin(),
+                             _groups.end(),
+                             std::make_pair(task, 0u)));
+
+    return it != _groups.end() && it->first == task ? it : _groups.end();
+  }
+
+  unsigned _degree;
+
+  // (task, group) pairs in ascending order
+  group_list _groups;
+  std::vector<unsigned> _group_offsets;
+  std::vector<unsigned> _positions;
+
+  std::vector<std::pair<unsigned, unsigned>> _buffer;
+};
+
+} // namespace internal
+
 class TaskMapping : public std::vector<unsigned>
 {
 public:
@@ -30,7 +170,7 @@ public:
   : std::vector<unsigned>(tasks)
   {}
 
-  bool less_than(TaskMapping const other) const
+  bool less_than(TaskMapping const &other) const
   {
     assert(size() == other.size());
 
@@ -48,7 +188,7 @@ public:
   }
 
   template<typename PERM>
-  bool less_than(TaskMapping const other,
+  bool less_than(TaskMapping const &other,
                  PERM const &perm,
                  unsigned offset = 0u) const
   {
@@ -117,7 +257,90 @@ public:
     return res;
   }
 
+  // whether permuting this mapping by perm via an index is cheaper than
+  // permuting all of its tasks, i.e. whether perm moves fewer points than
+  // there are tasks
+  bool permute_sparsely(internal::SparsePerm const &perm) const
+  { return perm.support_size() < size(); }
+
+  // equivalent to less_than(*this, perm, offset) but only visits the tasks
+  // moved by perm, index must index this mapping
+  bool permuted_less_than(internal::SparsePerm const &perm,
+                          internal::TaskMappingIndex const &index,
+                          unsigned offset = 0u) const
+  {
+    assert(perm.degree() == index.degree());
+
+    // the first position at which the permuted mapping differs from this one
+    unsigned i_min = static_cast<unsigned>(size());
+    unsigned task_permuted_min = 0u;
+
+    for (unsigned i = 0u; i < perm.support_size(); ++i) {
+      auto positions(index.positions(perm.support(i)));
+
+      if (positions.first == positions.second)
+        continue;
+
+      unsigned i_first = *positions.first;
+
+      if (i_first < i_min) {
+        i_min = i_first;
+        task_permuted_min = perm.image(i) + offset;
+      }
+    }
+
+    return i_min < size() && task_permuted_min < (*this)[i_min];
+  }
+
+  // equivalent to permute(perm, offset, modified) but only visits the tasks
+  // moved by perm, index must index this mapping (or a copy of it) and has to
+  // be updated separately via index.permute(perm)
+  void permute(internal::SparsePerm const &perm,
+               internal::TaskMappingIndex const &index,
+               unsigned offset = 0u,
+               bool *modified = nullptr)
+  { permute_sparse(perm, index, offset, *this, modified); }
+
+  TaskMapping permuted(internal::SparsePerm const &perm,
+                       internal::TaskMappingIndex const &index,
+                       unsigned offset = 0u,
+                       bool *modified = nullptr) const
+  {
+    TaskMapping res(*this);
+
+    permute_sparse(perm, index, offset, res, modified);
+
+    return res;
+  }
+
 private:
+  static void permute_sparse(internal::SparsePerm const &perm,
+                             internal::TaskMappingIndex const &index,
+                             unsigned offset,
+                             TaskMapping &res,
+                             bool *modified)
+  {
+    assert(perm.degree() == index.degree());
+
+    if (modified)
+      *modified = false;
+
+    for (unsigned i = 0u; i < perm.support_size(); ++i) {
+      auto positions(index.positions(perm.support(i)));
+
+      if (positions.first == positions.second)
+        continue;
+
+      if (modified)
+        *modified = true;
+
+      unsigned task_permuted = perm.image(i) + offset;
+
+      for (auto it = positions.first; it != positions.second; ++it)
+        res[*it] = task_permuted;
+    }
+  }
+
   template<typename PERM, typename FUNC>
   bool foreach_permuted_task_(PERM &&perm,
                               unsigned offset,
@@ -144,11 +367,30 @@ private:
   foreach_permuted_task(PERM const &perm,
                         unsigned offset,
                         FUNC &&func) const
+  {
+    switch (perm.width()) {
+      case 1u:
+        return foreach_permuted_task_images(
+          perm.template data<uint8_t>(), perm.degree(), offset, func);
+      case 2u:
+        return foreach_permuted_task_images(
+          perm.template data<uint16_t>(), perm.degree(), offset, func);
+      default:
+        return foreach_permuted_task_images(
+          perm.template data<uint32_t>(), perm.degree(), offset, func);
+    }
+  }
+
+  template<typename T, typename FUNC>
+  bool foreach_permuted_task_images(T const *images,
+                                    unsigned degree,
+                                    unsigned offset,
+                                    FUNC &&func) const
   {
     return foreach_permuted_task_(
-      [&](unsigned task){ return perm[task]; },
+      [&](unsigned task) -> unsigned { return images[task]; },
       offset,
-      perm.degree(),
+      degree,
       func);
   }
 
@@ -2,15 +2,22 @@
 #define GUARD_TASK_MAPPING_ORBIT_H
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "mapped_task_mappings.hpp"
+#include "packed_task_mappings.hpp"
 #include "perm_set.hpp"
+#include "sparse_perm.hpp"
 #include "task_mapping.hpp"
 #include "util.hpp"
 
@@ -19,40 +26,50 @@ namespace mpsym
 
 class TMO
 {
-  class IterationState
+  class Hash
   {
-    using hash_type = uint32_t;
-
   public:
-    IterationState(TMO const *orbit)
-    : _singular(orbit->_generators.empty()),
-      _generators(&orbit->_generators),
-      _unprocessed{orbit->_root}
-    {
-      current = _unprocessed.begin();
-
-      if (!_singular)
-        init_hash(orbit->_root);
-    }
+    using hash_type = uint64_t;
 
-    std::unordered_set<TaskMapping>::iterator current;
+    Hash(TaskMapping const &root, internal::PermSet const &generators);
 
-    void advance();
-    bool exhausted() const;
+    hash_type operator()(TaskMapping const &mapping) const
+    { return _perfect ? perfect_hash(mapping)
+                      : container_hash_truncated(mapping); }
 
   private:
-    void init_hash(TaskMapping const &root);
     hash_type perfect_hash(TaskMapping const &mapping) const;
     static hash_type container_hash_truncated(TaskMapping const &mapping);
 
+    bool _perfect;
+    std::vector<unsigned> _support_map;
+    unsigned _support_size;
+  };
+
+  class IterationState
+  {
+  public:
+    IterationState(TMO const *orbit);
+
+    TaskMapping const &current() const
+    { return _current; }
+
+    void advance();
+    bool exhausted() const;
+
+  private:
     bool _singular;
+    bool _exhausted;
     internal::PermSet const *_generators;
+    std::vector<internal::SparsePerm> const *_generators_sparse;
+
+    Hash _hash;
 
-    std::function<hash_type(TaskMapping)> _hash;
-    std::unordered_map<unsigned, unsigned> _hash_support_map;
+    TaskMapping _current, _next;
+    internal::TaskMappingIndex _index;
 
-    std::unordered_set<TaskMapping> _unprocessed;
-    std::unordered_set<hash_type> _processed;
+    internal::PackedTaskMappings _unprocessed;
+    internal::HashValueSet _processed;
   };
 
 public:
@@ -71,7 +88,7 @@ public:
 
   private:
     reference current() override
-    { return *_state->current; }
+    { return _state->current(); }
 
     void next() override
     { _state->advance(); }
@@ -84,7 +101,8 @@ public:
 
   TMO(TaskMapping const &mapping, internal::PermSet const &generators)
   : _root(mapping),
-    _generators(generators)
+    _generators(generators),
+    _generators_sparse(internal::sparse_perms(generators))
   {
 #ifndef NDEBUG
     if (!generators.empty()) {
@@ -102,43 +120,78 @@ public:
   const_iterator end() const
   { return const_iterator(); }
 
+  // enumerate the orbit breadth first, one level at a time, expanding the
+  // mappings of each level using num_threads threads (zero means one per
+  // hardware thread), func is called exactly once for every orbit element
+  // (possibly concurrently from different threads) and orbit elements are
+  // never stored in unpacked form
+  void for_each(std::function<void(TaskMapping const &)> const &func,
+                unsigned num_threads = 0u) const;
+
 private:
+  static constexpr std::size_t MIN_HEADROOM = 1024u;
+
   TaskMapping _root;
   internal::PermSet _generators;
+  std::vector<internal::SparsePerm> _generators_sparse;
 };
 
 class TMORs
 {
-  using orbit_reprs_map = std::unordered_map<TaskMapping, unsigned>;
+  class Shard;
 
 public:
   class const_iterator
   : public util::Iterator<const_iterator, TaskMapping const>
   {
   public:
-    const_iterator(orbit_reprs_map::const_iterator const &it)
-    : _it(it)
+    const_iterator(TMORs const *orbits, unsigned equivalence_class)
+    : _orbits(orbits),
+      _equivalence_class(equivalence_class)
     {}
 
     bool operator==(const_iterator const &rhs) const override
-    { return _it == rhs._it; }
+    { return _equivalence_class == rhs._equivalence_class; }
 
   private:
     reference current() override
-    { return _it->first; }
+    { return _orbits->orbit_repr(_equivalence_class, _current); }
 
     void next() override
-    { ++_it; }
+    { ++_equivalence_class; }
 
-    orbit_reprs_map::const_iterator _it;
+    TMORs const *_orbits;
+    unsigned _equivalence_class;
+    TaskMapping _current;
   };
 
+  TMORs();
+
+  // orbit representatives stored in a memory mapped file (created if it does
+  // not exist yet) which persists them and can be shared between processes,
+  // all representatives must consist of mapping_size tasks not larger than
+  // max_task and at most capacity of them can be stored, see
+  // internal::MappedTaskMappings, copies are always held in memory
+  static TMORs mapped(std::string const &file,
+                      unsigned mapping_size,
+                      unsigned max_task,
+                      std::size_t capacity);
+
+  TMORs(TMORs const &other);
+  TMORs(TMORs &&other);
+  ~TMORs();
+
+  TMORs &operator=(TMORs const &rhs);
+  TMORs &operator=(TMORs &&rhs);
+
   bool operator==(TMORs const &rhs) const
   { return orbit_repr_set() == rhs.orbit_repr_set(); }
 
   bool operator!=(TMORs const &rhs) const
   { return !(*this == rhs); }
 
+  // may be called concurrently, equivalence classes are numbered densely in
+  // the order in which new orbit representatives are encountered
   std::pair<bool, unsigned> insert(TaskMapping const &mapping);
 
   template<typename IT>
@@ -148,33 +201,66 @@ public:
       insert(*it);
   }
 
-  bool is_repr(TaskMapping const &mapping) const
-  {
-    auto it(_orbit_reprs.find(mapping));
-
-    return it != _orbit_reprs.end();
-  }
+  // lock-free, may be called concurrently with insert
+  bool is_repr(TaskMapping const &mapping) const;
 
   unsigned num_orbits() const
-  { return static_cast<unsigned>(_orbit_reprs.size()); }
+  { return _mapped ? _mapped->size() : _num_orbits.load(); }
+
+  TaskMapping orbit_repr(unsigned equivalence_class) const
+  {
+    TaskMapping buf;
+    return orbit_repr(equivalence_class, buf);
+  }
 
+  // iteration must not overlap with concurrent insertions
   const_iterator begin() const
-  { return const_iterator(_orbit_reprs.begin()); }
+  { return const_iterator(this, 0u); }
 
   const_iterator end() const
-  { return const_iterator(_orbit_reprs.end()); }
+  { return const_iterator(this, num_orbits()); }
 
 private:
+  static constexpr unsigned NUM_SHARDS = 64u;
+  static constexpr unsigned NUM_CHUNKS = 32u;
+  static constexpr unsigned CHUNK_SIZE_LOG2_MIN = 6u;
+
+  static uint64_t hash(TaskMapping const &mapping);
+
+  // shards are only allocated on first insertion, before that shard returns
+  // a null pointer
+  Shard const *shard(uint64_t h) const;
+  Shard &shard_create(uint64_t h);
+
+  bool find(Shard const &shard,
+            uint64_t h,
+            TaskMapping const &mapping,
+            unsigned *equivalence_class) const;
+
+  // returns a reference to either a stored representative or buf
+  TaskMapping const &orbit_repr(unsigned equivalence_class,
+                                TaskMapping &buf) const;
+
+  TaskMapping const &orbit_repr_stored(unsigned equivalence_class) const;
+  TaskMapping &orbit_repr_slot(unsigned equivalence_class);
+
+  // frees all representatives (and shards), never allocates
+  void clear();
+
   std::unordered_set<TaskMapping> orbit_repr_set() const
   {
     std::unordered_set<TaskMapping> ret;
-    for (auto const &repr : _orbit_reprs)
-      ret.insert(repr.first);
+    for (auto const &repr : *this)
+      ret.insert(repr);
 
     return ret;
   }
 
-  orbit_reprs_map _orbit_reprs;
+  std::atomic<Shard *> _shards;
+  std::atomic<TaskMapping *> _chunks[NUM_CHUNKS];
+  std::atomic<unsigned> _num_orbits;
+
+  std::unique_ptr<internal::MappedTaskMappings> _mapped;
 };
 
 } // namespace mpsym
@@ -75,6 +75,38 @@ inline void set(flag const &f)
 inline bool is_set(flag const &f)
 { return f->load(); }
 
+// flags registered with schedule_deadline are set by a single shared timer
+// thread once their deadline has passed unless they are cancelled before that
+
+using deadline_id = unsigned long long;
+
+deadline_id schedule_deadline(flag const &f,
+                              std::chrono::steady_clock::time_point deadline);
+
+void cancel_deadline(deadline_id id);
+
+class ScopedDeadline
+{
+public:
+  template<typename REP, typename PERIOD>
+  ScopedDeadline(flag const &f,
+                 std::chrono::duration<REP, PERIOD> const &timeout)
+  : _id(schedule_deadline(
+      f,
+      std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout)))
+  {}
+
+  ~ScopedDeadline()
+  { cancel_deadline(_id); }
+
+  ScopedDeadline(ScopedDeadline const &) = delete;
+  ScopedDeadline &operator=(ScopedDeadline const &) = delete;
+
+private:
+  deadline_id _id;
+};
+
 template<typename FUNC>
 using ReturnType = decltype(std::declval<FUNC>()());
 
@@ -165,13 +197,17 @@ run_abortable_with_timeout(std::string const &what,
   if (timeout <= std::chrono::duration<double>::zero())
     return f(aborted);
 
+  // f runs on the calling thread and is expected to throw AbortedError soon
+  // after the timer thread has set the flag
+  ScopedDeadline deadline(aborted, timeout);
+
   try {
-    return run_with_timeout(what,
-                            timeout,
-                            [&]{ return f(aborted); });
+    return f(aborted);
+
+  } catch (AbortedError const &) {
+    if (is_set(aborted))
+      throw TimeoutError(what);
 
-  } catch (TimeoutError const &) {
-    set(aborted);
     throw;
   }
 }
@@ -0,0 +1,480 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include <getopt.h>
+#include <libgen.h>
+
+#include "arch_graph.hpp"
+#include "arch_graph_system.hpp"
+#include "bsgs.hpp"
+#include "orbit.hpp"
+#include "perm.hpp"
+#include "perm_group.hpp"
+#include "perm_set.hpp"
+#include "string.hpp"
+#include "task_mapping.hpp"
+
+#include "profile_util.hpp"
+
+using namespace profile;
+
+using mpsym::ArchGraph;
+using mpsym::ReprOptions;
+using mpsym::TaskMapping;
+using mpsym::internal::BSGS;
+using mpsym::internal::BSGSOptions;
+using mpsym::internal::Orbit;
+using mpsym::internal::Perm;
+using mpsym::internal::PermGroup;
+using mpsym::internal::PermSet;
+
+using json = nlohmann::json;
+
+namespace
+{
+
+std::string progname;
+
+void usage(std::ostream &s)
+{
+  char const *opts[] = {
+    "[-h|--help]",
+    "[-f|--filter PATTERN]",
+    "[-d|--degree DEGREE]",
+    "[-r|--repetitions REPETITIONS]",
+    "[--min-time SECONDS]",
+    "[-o|--output OUTPUT_FILE]",
+    "[-b|--baseline BASELINE_FILE]",
+    "[-t|--tolerance TOLERANCE]"
+  };
+
+  s << "usage: " << progname << '\n';
+  for (char const *opt : opts)
+    s << "  " << opt << '\n';
+}
+
+struct ProfileOptions
+{
+  std::string filter;
+  unsigned degree = 64u;
+  unsigned repetitions = 5u;
+  double min_time = 0.05;
+  std::string output;
+  std::string baseline;
+  double tolerance = 0.1;
+};
+
+// prevent the compiler from optimizing away computations whose results are
+// otherwise unused
+template<typename T>
+void keep(T const &value)
+{ asm volatile("" : : "g"(&value) : "memory"); }
+
+class Benchmarks
+{
+public:
+  Benchmarks(ProfileOptions const &options)
+  : _options(options)
+  {}
+
+  // median time per call of func in nanoseconds, the number of calls per
+  // repetition is doubled until a repetition takes at least min_time seconds
+  template<typename FUNC>
+  void run(std::string const &name, FUNC &&func)
+  {
+    if (name.find(_options.filter) == std::string::npos)
+      return;
+
+    unsigned long n = 1ul;
+    while (measure(n, func) < _options.min_time)
+      n *= 2ul;
+
+    std::vector<double> times(_options.repetitions);
+    for (auto &time : times)
+      time = measure(n, func) / static_cast<double>(n) * 1e9;
+
+    std::nth_element(times.begin(),
+                     times.begin() + times.size() / 2u,
+                     times.end());
+
+    double median = times[times.size() / 2u];
+
+    result("benchmark:", name, "ns/op:", median);
+
+    _results[name] = median;
+  }
+
+  std::map<std::string, double> const &results() const
+  { return _results; }
+
+private:
+  template<typename FUNC>
+  static double measure(unsigned long n, FUNC &&func)
+  {
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned long i = 0ul; i < n; ++i)
+      func();
+
+    auto stop = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double>(stop - start).count();
+  }
+
+  ProfileOptions _options;
+  std::map<std::string, double> _results;
+};
+
+Perm random_perm(unsigned degree, std::mt19937 &gen)
+{
+  std::vector<unsigned> perm(degree);
+  std::iota(perm.begin(), perm.end(), 0u);
+  std::shuffle(perm.begin(), perm.end(), gen);
+
+  return Perm(perm);
+}
+
+// the wreath product S_(degree / 4) wr S_4, large enough to make stripping
+// and transversal lookups non-trivial without triggering any of the special
+// cases for symmetric groups
+PermSet wreath_generators(unsigned degree)
+{
+  unsigned block = degree / 4u;
+
+  PermSet generators;
+
+  for (unsigned b = 0u; b < 4u; ++b) {
+    std::vector<unsigned> cycle(block);
+    std::iota(cycle.begin(), cycle.end(), b * block);
+
+    generators.emplace(degree, std::vector<std::vector<unsigned>>{cycle});
+    generators.emplace(
+      degree,
+      std::vector<std::vector<unsigned>>{{b * block, b * block + 1u}});
+  }
+
+  std::vector<unsigned> shift(degree);
+  for (unsigned i = 0u; i < degree; ++i)
+    shift[i] = (i + block) % degree;
+
+  generators.emplace(shift);
+
+  return generators;
+}
+
+void mesh(ArchGraph &ag, unsigned width, unsigned height)
+{
+  auto pt(ag.new_processor_type("p"));
+  auto ct(ag.new_channel_type("c"));
+
+  ag.add_processors(width * height, pt);
+
+  for (unsigned y = 0u; y < height; ++y) {
+    for (unsigned x = 0u; x < width; ++x) {
+      unsigned pe = y * width + x;
+
+      if (x + 1u < width)
+        ag.add_channel(pe, pe + 1u, ct);
+
+      if (y + 1u < height)
+        ag.add_channel(pe, pe + width, ct);
+    }
+  }
+}
+
+void profile_perm(Benchmarks &benchmarks, ProfileOptions const &options)
+{
+  std::mt19937 gen(0u);
+
+  auto lhs(random_perm(options.degree, gen));
+  auto rhs(random_perm(options.degree, gen));
+
+  benchmarks.run("perm_compose", [&]{
+    lhs *= rhs;
+    keep(lhs);
+  });
+
+  benchmarks.run("perm_invert", [&]{
+    keep(~lhs);
+  });
+
+  PermSet generators;
+  for (unsigned i = 0u; i < 8u; ++i)
+    generators.insert(random_perm(options.degree, gen));
+
+  benchmarks.run("perm_set_with_inverses", [&]{
+    keep(generators.with_inverses());
+  });
+}
+
+void profile_bsgs(Benchmarks &benchmarks, ProfileOptions const &options)
+{
+  using Transversals = BSGSOptions::Transversals;
+
+  std::vector<std::pair<char const *, Transversals>> transversals {
+    {"explicit", Transversals::EXPLICIT},
+    {"schreier_trees", Transversals::SCHREIER_TREES},
+    {"schreier_vector", Transversals::SCHREIER_VECTOR}
+  };
+
+  auto generators(wreath_generators(options.degree));
+
+  for (auto const &t : transversals) {
+    BSGSOptions bsgs_options;
+    bsgs_options.check_sym = false;
+    bsgs_options.transversals = t.second;
+
+    PermGroup group(BSGS(options.degree, generators, &bsgs_options));
+    auto const &bsgs(group.bsgs());
+
+    std::vector<Perm> elements;
+    for (unsigned i = 0u; i < 64u; ++i)
+      elements.push_back(group.random_element());
+
+    std::string suffix(std::string("/") + t.first);
+
+    unsigned e = 0u;
+    benchmarks.run("bsgs_strip" + suffix, [&]{
+      keep(bsgs.strip(elements[e]));
+      e = (e + 1u) % elements.size();
+    });
+
+    std::vector<std::pair<unsigned, unsigned>> points;
+    for (unsigned i = 0u; i < bsgs.base_size(); ++i) {
+      for (unsigned o : bsgs.orbit(i))
+        points.emplace_back(i, o);
+    }
+
+    unsigned p = 0u;
+    benchmarks.run("schreier_structure_transversal" + suffix, [&]{
+      keep(bsgs.transversal(points[p].first, points[p].second));
+      p = (p + 1u) % points.size();
+    });
+  }
+
+  auto generators_with_inverses(generators.with_inverses());
+
+  benchmarks.run("orbit_generate", [&]{
+    keep(Orbit::generate(0u, generators_with_inverses));
+  });
+}
+
+void profile_task_mapping(Benchmarks &benchmarks, ProfileOptions const &options)
+{
+  std::mt19937 gen(0u);
+
+  std::uniform_int_distribution<unsigned> d(0u, options.degree - 1u);
+
+  TaskMapping mapping;
+  for (unsigned i = 0u; i < options.degree / 2u; ++i)
+    mapping.push_back(d(gen));
+
+  auto perm(random_perm(options.degree, gen));
+
+  benchmarks.run("task_mapping_permuted", [&]{
+    keep(mapping.permuted(perm));
+  });
+}
+
+void profile_repr(Benchmarks &benchmarks, ProfileOptions const &)
+{
+  using Method = ReprOptions::Method;
+
+  std::vector<std::pair<char const *, Method>> methods {
+    {"iterate", Method::ITERATE},
+    {"local_search", Method::LOCAL_SEARCH},
+    {"orbits", Method::ORBITS},
+    {"backtrack", Method::BACKTRACK}
+  };
+
+  ArchGraph ag;
+  mesh(ag, 4u, 4u);
+
+  std::mt19937 gen(0u);
+
+  std::uniform_int_distribution<unsigned> d(0u, ag.num_processors() - 1u);
+
+  std::vector<TaskMapping> mappings(64u);
+  for (auto &mapping : mappings) {
+    for (unsigned i = 0u; i < 8u; ++i)
+      mapping.push_back(d(gen));
+  }
+
+  for (auto const &m : methods) {
+    ReprOptions repr_options;
+    repr_options.method = m.second;
+
+    ag.prepare_repr(&repr_options);
+
+    unsigned i = 0u;
+    benchmarks.run(std::string("repr/") + m.first, [&]{
+      keep(ag.repr(mappings[i], &repr_options));
+      i = (i + 1u) % mappings.size();
+    });
+  }
+}
+
+bool compare_baseline(std::map<std::string, double> const &results,
+                      std::string const &baseline_file,
+                      double tolerance)
+{
+  std::ifstream f(baseline_file);
+  if (!f)
+    throw std::runtime_error("failed to open baseline file");
+
+  json baseline;
+  f >> baseline;
+
+  auto const &baseline_results(baseline.at("benchmarks"));
+
+  bool success = true;
+
+  for (auto const &r : results) {
+    auto it(baseline_results.find(r.first));
+    if (it == baseline_results.end()) {
+      warning("no baseline for", r.first);
+      continue;
+    }
+
+    double ratio = r.second / it->get<double>();
+
+    if (ratio > 1.0 + tolerance) {
+      error("regression:", r.first, "ratio:", ratio);
+      success = false;
+    } else {
+      info("benchmark:", r.first, "ratio:", ratio);
+    }
+  }
+
+  return success;
+}
+
+void write_results(std::map<std::string, double> const &results,
+                   std::string const &output_file)
+{
+  json j;
+  j["unit"] = "ns/op";
+  j["benchmarks"] = results;
+
+  if (output_file == "-") {
+    std::cout << j.dump(2) << '\n';
+    return;
+  }
+
+  std::ofstream f(output_file);
+  if (!f)
+    throw std::runtime_error("failed to open output file");
+
+  f << j.dump(2) << '\n';
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  using mpsym::util::stof;
+  using mpsym::util::stox;
+
+  progname = basename(argv[0]);
+
+  struct option long_options[] = {
+    {"help",        no_argument,       0,       'h'},
+    {"filter",      required_argument, 0,       'f'},
+    {"degree",      required_argument, 0,       'd'},
+    {"repetitions", required_argument, 0,       'r'},
+    {"min-time",    required_argument, 0,        1 },
+    {"output",      required_argument, 0,       'o'},
+    {"baseline",    required_argument, 0,       'b'},
+    {"tolerance",   required_argument, 0,       't'},
+    {nullptr,       0,                 nullptr,  0 }
+  };
+
+  ProfileOptions options;
+
+  for (;;) {
+    int c = getopt_long(argc, argv, "hf:d:r:o:b:t:", long_options, nullptr);
+    if (c == -1)
+      break;
+
+    try {
+      switch(c) {
+      case 'h':
+        usage(std::cout);
+        return EXIT_SUCCESS;
+      case 'f':
+        options.filter = optarg;
+        break;
+      case 'd':
+        options.degree = stox<unsigned>(optarg);
+        break;
+      case 'r':
+        options.repetitions = stox<unsigned>(optarg);
+        break;
+      case 1:
+        options.min_time = stof<double>(optarg);
+        break;
+      case 'o':
+        options.output = optarg;
+        break;
+      case 'b':
+        options.baseline = optarg;
+        break;
+      case 't':
+        options.tolerance = stof<double>(optarg);
+        break;
+      default:
+        return EXIT_FAILURE;
+      }
+    } catch (std::invalid_argument const &e) {
+      error("invalid option argument:", e.what());
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (options.degree < 8u || options.degree % 4u != 0u) {
+    error("degree must be a multiple of four and at least eight");
+    return EXIT_FAILURE;
+  }
+
+  if (options.repetitions == 0u) {
+    error("number of repetitions must be positive");
+    return EXIT_FAILURE;
+  }
+
+  Benchmarks benchmarks(options);
+
+  profile_perm(benchmarks, options);
+  profile_bsgs(benchmarks, options);
+  profile_task_mapping(benchmarks, options);
+  profile_repr(benchmarks, options);
+
+  try {
+    if (!options.output.empty())
+      write_results(benchmarks.results(), options.output);
+
+    if (!options.baseline.empty() &&
+        !compare_baseline(benchmarks.results(),
+                          options.baseline,
+                          options.tolerance)) {
+      return EXIT_FAILURE;
+    }
+  } catch (std::exception const &e) {
+    error(e.what());
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <getopt.h>
+#include <libgen.h>
+
+#include "perm_kernels.hpp"
+#include "string.hpp"
+
+#include "profile_util.hpp"
+
+using namespace profile;
+
+using mpsym::internal::PermKernelVariant;
+
+namespace
+{
+
+std::string progname;
+
+void usage(std::ostream &s)
+{
+  char const *opts[] = {
+    "[-h|--help]",
+    "[--min-degree MIN_DEGREE]",
+    "[--max-degree MAX_DEGREE]",
+    "[-p|--products NUM_PRODUCTS]"
+  };
+
+  s << "usage: " << progname << '\n';
+  for (char const *opt : opts)
+    s << "  " << opt << '\n';
+}
+
+struct ProfileOptions
+{
+  unsigned min_degree = 8u;
+  unsigned max_degree = 4096u;
+  unsigned long num_products = 1u << 24;
+};
+
+template<typename T>
+std::vector<T> random_perm(unsigned degree, std::mt19937 &gen)
+{
+  std::vector<T> perm(degree);
+  std::iota(perm.begin(), perm.end(), 0u);
+  std::shuffle(perm.begin(), perm.end(), gen);
+
+  return perm;
+}
+
+// products per second, the number of multiplications is scaled by the degree
+// such that each measurement touches roughly the same number of elements
+template<typename FUNC>
+double measure(unsigned degree, ProfileOptions const &options, FUNC &&func)
+{
+  unsigned long n = std::max(options.num_products / degree, 1ul);
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (unsigned long i = 0ul; i < n; ++i)
+    func();
+
+  auto stop = std::chrono::steady_clock::now();
+
+  std::chrono::duration<double> elapsed(stop - start);
+
+  return static_cast<double>(n) / elapsed.count();
+}
+
+template<typename T>
+void profile_width(char const *width, ProfileOptions const &options)
+{
+  using mpsym::internal::perm_compose;
+  using mpsym::internal::perm_invert;
+  using mpsym::internal::perm_kernel_variant_name;
+  using mpsym::internal::perm_kernel_variant_supported;
+
+  std::mt19937 gen(0u);
+
+  for (unsigned degree = options.min_degree;
+       degree <= options.max_degree;
+       degree *= 2u) {
+
+    if (degree - 1u > std::numeric_limits<T>::max())
+      break;
+
+    auto lhs(random_perm<T>(degree, gen));
+    auto rhs(random_perm<T>(degree, gen));
+    std::vector<T> inverse(degree);
+
+    for (auto variant : {PermKernelVariant::SCALAR,
+                         PermKernelVariant::AVX2,
+                         PermKernelVariant::AVX512}) {
+
+      if (!perm_kernel_variant_supported(variant))
+        continue;
+
+      double compose = measure(degree, options, [&]{
+        perm_compose(lhs.data(), rhs.data(), degree, variant);
+      });
+
+      double invert = measure(degree, options, [&]{
+        perm_invert(lhs.data(), inverse.data(), degree, variant);
+      });
+
+      result("width:", width,
+             "degree:", degree,
+             "variant:", perm_kernel_variant_name(variant),
+             "compose/s:", compose,
+             "invert/s:", invert);
+    }
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  using mpsym::util::stox;
+
+  progname = basename(argv[0]);
+
+  struct option long_options[] = {
+    {"help",       no_argument,       0,       'h'},
+    {"min-degree", required_argument, 0,        1 },
+    {"max-degree", required_argument, 0,        2 },
+    {"products",   required_argument, 0,       'p'},
+    {nullptr,      0,                 nullptr,  0 }
+  };
+
+  ProfileOptions options;
+
+  for (;;) {
+    int c = getopt_long(argc, argv, "hp:", long_options, nullptr);
+    if (c == -1)
+      break;
+
+    try {
+      switch(c) {
+      case 'h':
+        usage(std::cout);
+        return EXIT_SUCCESS;
+      case 1:
+        options.min_degree = stox<unsigned>(optarg);
+        break;
+      case 2:
+        options.max_degree = stox<unsigned>(optarg);
+        break;
+      case 'p':
+        options.num_products = stox<unsigned long>(optarg);
+        break;
+      default:
+        return EXIT_FAILURE;
+      }
+    } catch (std::invalid_argument const &e) {
+      error("invalid option argument:", e.what());
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (options.min_degree == 0u || options.min_degree > options.max_degree) {
+    error("invalid degree range");
+    return EXIT_FAILURE;
+  }
+
+  info("Best supported variant:",
+       mpsym::internal::perm_kernel_variant_name(
+         mpsym::internal::perm_kernel_variant()));
+
+  profile_width<uint8_t>("8", options);
+  profile_width<uint16_t>("16", options);
+  profile_width<uint32_t>("32", options);
+
+  return EXIT_SUCCESS;
+}
@@ -44,7 +44,9 @@ void usage(std::ostream &s)
     "[-h|--help]",
     "-i|--implementation  {gap|mpsym|permlib}",
     "[-s|--schreier-sims] {deterministic|random|random-no-guarantee}",
-    "[-t|--transversals]  {explicit|schreier-trees|shallow-schreier-trees}",
+    "[-t|--transversals]  {explicit|schreier-trees|shallow-schreier-trees|",
+    "                      schreier-vector}",
+    "[--schreier-sims-random-threads NUM_THREADS]",
     "[--bsgs-options      {dont_check_sym,",
     "                      dont_reduce_gens,",
     "                      dont_use_known_order",
@@ -73,7 +75,8 @@ struct ProfileOptions
 
   VariantOption transversals{"explicit",
                              "schreier-trees",
-                             "shallow-schreier-trees"};
+                             "shallow-schreier-trees",
+                             "schreier-vector"};
 
   VariantOptionSet bsgs_options{"dont_check_sym",
                                 "dont_reduce_gens",
@@ -82,6 +85,8 @@ struct ProfileOptions
 
   std::vector<std::string> arch_graph_args;
 
+  unsigned schreier_sims_random_threads = 1u;
+
   bool groups_input = false;
   bool arch_graph_input = false;
   unsigned num_runs = 1u;
@@ -116,9 +121,14 @@ mpsym::internal::BSGSOptions bsgs_options_mpsym(ProfileOptions const &options)
     bsgs_options.transversals = BSGSOptions::Transversals::SCHREIER_TREES;
   else if (options.transversals.is("shallow-schreier-trees"))
     bsgs_options.transversals = BSGSOptions::Transversals::SHALLOW_SCHREIER_TREES;
+  else if (options.transversals.is("schreier-vector"))
+    bsgs_options.transversals = BSGSOptions::Transversals::SCHREIER_VECTOR;
   else
     throw std::logic_error("unreachable");
 
+  bsgs_options.schreier_sims_random_threads =
+    options.schreier_sims_random_threads;
+
   if (options.bsgs_options.is_set("dont_check_sym"))
     bsgs_options.check_sym = false;
 
@@ -395,6 +405,8 @@ int main(int argc, char **argv)
     {"verbose",             no_argument,       0,       'v'},
     {"compile-gap",         no_argument,       0,        5 },
     {"show-gap-errors",     no_argument,       0,        6 },
+    {"schreier-sims-random-threads",
+                            required_argument, 0,        7 },
     {nullptr,               0,                 nullptr,  0 }
   };
 
@@ -458,6 +470,9 @@ int main(int argc, char **argv)
       case 6:
         options.show_gap_errors = true;
         break;
+      case 7:
+        options.schreier_sims_random_threads = stox<unsigned>(optarg);
+        break;
       default:
         return EXIT_FAILURE;
       }
@@ -476,6 +491,10 @@ int main(int argc, char **argv)
   CHECK_OPTION((options.implementation.is("gap") || options.transversals.is_set()),
                "--transversal-storage option is mandatory when not using gap");
 
+  CHECK_OPTION((!options.implementation.is("permlib") ||
+                !options.transversals.is("schreier-vector")),
+               "schreier-vector transversals only supported by mpsym");
+
   CHECK_OPTION(options.groups_input != options.arch_graph_input,
                "EITHER --arch-graph OR --groups must be given");
 
@@ -10,6 +10,7 @@
 
 #include <getopt.h>
 #include <libgen.h>
+#include <sys/resource.h>
 
 #include "arch_graph_automorphisms.hpp"
 #include "arch_graph_system.hpp"
@@ -36,13 +37,14 @@ void usage(std::ostream &s)
   char const *opts[] = {
     "[-h|--help]",
     "-i|--implementation {gap|mpsym}",
-    "-m|--repr-method {iterate|orbits|local_search}",
+    "-m|--repr-method {iterate|orbits|local_search|backtrack}",
     "--repr-variant {local_search_bfs|local_search_dfs|local_search_sa_linear}",
     "--repr-local-search-invert-generators",
     "--repr-local-search-append-generators",
     "--repr-local-search-iterations",
     "--repr-local-search-sa-T-init",
     "[--repr-options {dont_decompose,dont_match,dont_optimize_symmetric}]",
+    "[--enumerate-orbits]",
     "[-g|--groups GROUPS]",
     "[-a|--arch-graph ARCH_GRAPH]",
     "[--arch-graph-args ARCH_GRAPH_ARGS]",
@@ -67,7 +69,8 @@ void usage(std::ostream &s)
 struct ProfileOptions
 {
   VariantOption library{"gap", "mpsym"};
-  VariantOption repr_method{"iterate", "orbits", "local_search"};
+  VariantOption repr_method{
+    "iterate", "orbits", "local_search", "backtrack"};
   VariantOption repr_variant{
     "local_search_bfs", "local_search_dfs", "local_search_sa_linear"};
   VariantOptionSet repr_options{
@@ -78,6 +81,8 @@ struct ProfileOptions
   double repr_local_search_sa_iterations = 0.0;
   double repr_local_search_sa_T_init = 0.0;
 
+  bool enumerate_orbits = false;
+
   bool groups_input = false;
   bool arch_graph_input = false;
   std::vector<std::string> arch_graph_args;
@@ -253,6 +258,8 @@ mpsym::ReprOptions map_tasks_mpsym_repr_options(
     repr_options.method = ReprOptions::Method::ITERATE;
   } else if (options.repr_method.is("orbits")) {
     repr_options.method = ReprOptions::Method::ORBITS;
+  } else if (options.repr_method.is("backtrack")) {
+    repr_options.method = ReprOptions::Method::BACKTRACK;
   } else if (options.repr_method.is("local_search")) {
     repr_options.method = ReprOptions::Method::LOCAL_SEARCH;
 
@@ -296,6 +303,7 @@ mpsym::TMORs map_tasks_mpsym(
   ProfileOptions const &options)
 {
   using mpsym::ArchGraphSystem;
+  using mpsym::TaskMapping;
   using mpsym::TMORs;
   using mpsym::internal::ArchGraphAutomorphisms;
 
@@ -310,7 +318,19 @@ mpsym::TMORs map_tasks_mpsym(
     if (options.verbosity > 0)
       debug_progress("Mapping task", i + 1u, "of", task_mappings.size());
 
-    ags->repr(task_mappings[i], task_orbits, &repr_options);
+    if (options.enumerate_orbits) {
+      TaskMapping representative(task_mappings[i]);
+
+      for (auto const &mapping : ags->automorphisms_orbit(task_mappings[i])) {
+        if (mapping.less_than(representative))
+          representative = mapping;
+      }
+
+      task_orbits.insert(representative);
+
+    } else {
+      ags->repr(task_mappings[i], task_orbits, &repr_options);
+    }
   }
 
   return task_orbits;
@@ -387,6 +407,11 @@ void map_tasks_mpsym_wrapper(std::shared_ptr<mpsym::ArchGraphSystem> ags,
     debug_progress_done();
 
     debug("=> Found", task_orbits->num_orbits(), "orbit representatives");
+
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+      debug("=> Peak memory usage", usage.ru_maxrss, "KiB");
+
     if (options.verbosity > 1) {
       for (auto const &repr : *task_orbits)
         debug(DUMP(repr));
@@ -590,6 +615,7 @@ int main(int argc, char **argv)
     {"verbose",                             no_argument,       0,       'v'},
     {"compile-gap",                         no_argument,       0,        11},
     {"show-gap-errors",                     no_argument,       0,        12},
+    {"enumerate-orbits",                    no_argument,       0,        13},
     {nullptr,                               0,                 nullptr,  0 }
   };
 
@@ -678,6 +704,9 @@ int main(int argc, char **argv)
       case 12:
         options.show_gap_errors = true;
         break;
+      case 13:
+        options.enumerate_orbits = true;
+        break;
       default:
         return EXIT_FAILURE;
       }
@@ -701,6 +730,12 @@ int main(int argc, char **argv)
                !(options.check_accuracy_gap || options.check_accuracy_mpsym),
                "--check-accuracy-* only available when using mpsym");
 
+  CHECK_OPTION(!options.library.is("gap") || !options.enumerate_orbits,
+               "--enumerate-orbits only available when using mpsym");
+
+  CHECK_OPTION(!options.library.is("gap") || !options.repr_method.is("backtrack"),
+               "--repr-method backtrack only available when using mpsym");
+
   try {
     do_profile(automorphisms_stream, task_mappings_stream, options);
   } catch (std::exception const &e) {
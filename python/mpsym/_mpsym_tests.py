@@ -6,6 +6,11 @@ from math import factorial
 from random import sample
 from textwrap import dedent
 
+try:
+    import numpy as np
+except ImportError:
+    np = None
+
 import mpsym as mp
 
 
@@ -200,9 +205,32 @@ class ArchGraphSystemTest(unittest.TestCase):
     def test_representative(self):
         for orbit in [self.ag_orbit1, self.ag_orbit2]:
             for mapping in orbit:
-                for method in 'iterate', 'orbit':
+                for method in 'iterate', 'orbit', 'backtrack':
                     self.assertEqual(self.ag.representative(mapping, method=method), orbit[0])
 
+    @unittest.skipIf(np is None, "numpy not available")
+    def test_representatives(self):
+        mappings = np.array(self.ag_orbit1 + self.ag_orbit2, dtype=np.uint32)
+
+        expected = np.array([self.ag_orbit1[0]] * len(self.ag_orbit1) +
+                            [self.ag_orbit2[0]] * len(self.ag_orbit2))
+
+        for num_threads in 1, 4:
+            reprs = self.ag.representatives(mappings, num_threads=num_threads)
+
+            self.assertTrue(np.array_equal(reprs, expected))
+
+            representatives = mp.Representatives()
+
+            reprs, orbits_new, orbit_indices = self.ag.representatives(
+                mappings, representatives, num_threads=num_threads)
+
+            self.assertTrue(np.array_equal(reprs, expected))
+            self.assertEqual(np.count_nonzero(orbits_new), 2)
+            self.assertEqual(len(representatives), 2)
+            self.assertEqual(len(set(orbit_indices[:len(self.ag_orbit1)])), 1)
+            self.assertEqual(len(set(orbit_indices[len(self.ag_orbit1):])), 1)
+
     def test_orbit(self):
         for orbit in [self.ag_orbit1, self.ag_orbit2]:
             self.assertCountEqual(list(self.ag.orbit(orbit[0])), orbit)
@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <chrono>
+#include <cstddef>
 #include <cstring>
 #include <functional>
 #include <map>
@@ -18,6 +19,7 @@
 #include <boost/multiprecision/cpp_int.hpp>
 
 #include <nlohmann/json.hpp>
+#include <pybind11/numpy.h>
 #include <pybind11/operators.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/pytypes.h>
@@ -123,6 +125,8 @@ ReprOptions str_to_repr_options(std::string const &method)
     options.method = ReprOptions::Method::ITERATE;
   } else if (method == "orbit") {
     options.method = ReprOptions::Method::ORBITS;
+  } else if (method == "backtrack") {
+    options.method = ReprOptions::Method::BACKTRACK;
   } else if (method == "local_search_bfs") {
     options.method = ReprOptions::Method::LOCAL_SEARCH;
     options.variant = ReprOptions::Variant::LOCAL_SEARCH_BFS;
@@ -171,6 +175,43 @@ arch_graph_timeout(std::string const &what,
     { return (self.*f)(std::forward<ARGS>(args)..., aborted); });
 }
 
+// rows are task mappings, a C-contiguous array of matching type is accessed
+// without being copied
+using TaskMappingArray =
+  py::array_t<unsigned, py::array::c_style | py::array::forcecast>;
+
+void check_task_mapping_array(TaskMappingArray const &mappings)
+{
+  if (mappings.ndim() != 2)
+    throw std::invalid_argument("mappings must be a two-dimensional array");
+}
+
+// task mappings in every row of mappings, must not be called while holding
+// the GIL since automorphisms might have to be computed
+std::vector<TaskMapping> task_mapping_rows(ArchGraphSystem &self,
+                                           TaskMappingArray const &mappings)
+{
+  auto num_mappings = static_cast<std::size_t>(mappings.shape(0));
+  auto num_tasks = static_cast<std::size_t>(mappings.shape(1));
+
+  unsigned const *tasks = mappings.data();
+
+  for (std::size_t i = 0u; i < num_mappings * num_tasks; ++i) {
+    if (tasks[i] >= self.automorphisms_degree())
+      throw std::invalid_argument("task index out of range");
+  }
+
+  std::vector<TaskMapping> rows;
+  rows.reserve(num_mappings);
+
+  for (std::size_t i = 0u; i < num_mappings; ++i) {
+    rows.emplace_back(std::vector<unsigned>(tasks + i * num_tasks,
+                                            tasks + (i + 1u) * num_tasks));
+  }
+
+  return rows;
+}
+
 } // anonymous namespace
 
 namespace pybind11
@@ -437,7 +478,105 @@ PYBIND11_MODULE_(PYTHON_MODULE_INTERNAL, m)
                                   orbit_new,
                                   orbit_index);
          },
-         "mapping"_a, "representatives"_a, "method"_a = "auto", "timeout"_a = 0.0);
+         "mapping"_a, "representatives"_a, "method"_a = "auto", "timeout"_a = 0.0)
+    .def("representatives",
+         [&](ArchGraphSystem &self,
+             TaskMappingArray const &mappings,
+             std::string const &method,
+             unsigned num_threads,
+             double timeout)
+         {
+           check_task_mapping_array(mappings);
+
+           auto options(str_to_repr_options(method));
+
+           auto num_tasks = static_cast<std::size_t>(mappings.shape(1));
+
+           py::array_t<unsigned> reprs(
+             std::vector<std::size_t>{static_cast<std::size_t>(mappings.shape(0)),
+                                      num_tasks});
+
+           unsigned *repr_tasks = reprs.mutable_data();
+
+           std::vector<TaskMapping> repr_batch;
+
+           {
+             py::gil_scoped_release release;
+
+             repr_batch = run_abortable_with_timeout(
+               "representatives",
+               std::chrono::duration<double>(timeout),
+               [&](flag aborted)
+               {
+                 return self.repr_batch(task_mapping_rows(self, mappings),
+                                        &options,
+                                        num_threads,
+                                        aborted);
+               });
+           }
+
+           for (std::size_t i = 0u; i < repr_batch.size(); ++i) {
+             auto const &repr(repr_batch[i]);
+
+             std::copy(repr.begin(), repr.end(), repr_tasks + i * num_tasks);
+           }
+
+           return reprs;
+         },
+         "mappings"_a, "method"_a = "auto", "num_threads"_a = 1u, "timeout"_a = 0.0)
+    .def("representatives",
+         [&](ArchGraphSystem &self,
+             TaskMappingArray const &mappings,
+             TMORs &representatives,
+             std::string const &method,
+             unsigned num_threads,
+             double timeout)
+         {
+           check_task_mapping_array(mappings);
+
+           auto options(str_to_repr_options(method));
+
+           auto num_mappings = static_cast<std::size_t>(mappings.shape(0));
+           auto num_tasks = static_cast<std::size_t>(mappings.shape(1));
+
+           py::array_t<unsigned> reprs(
+             std::vector<std::size_t>{num_mappings, num_tasks});
+           py::array_t<bool> orbits_new(num_mappings);
+           py::array_t<unsigned> orbit_indices(num_mappings);
+
+           unsigned *repr_tasks = reprs.mutable_data();
+           bool *orbit_new = orbits_new.mutable_data();
+           unsigned *orbit_index = orbit_indices.mutable_data();
+
+           std::vector<std::tuple<TaskMapping, bool, unsigned>> repr_batch;
+
+           {
+             py::gil_scoped_release release;
+
+             repr_batch = run_abortable_with_timeout(
+               "representatives",
+               std::chrono::duration<double>(timeout),
+               [&](flag aborted)
+               {
+                 return self.repr_batch(task_mapping_rows(self, mappings),
+                                        representatives,
+                                        &options,
+                                        num_threads,
+                                        aborted);
+               });
+           }
+
+           for (std::size_t i = 0u; i < repr_batch.size(); ++i) {
+             TaskMapping repr;
+
+             std::tie(repr, orbit_new[i], orbit_index[i]) = repr_batch[i];
+
+             std::copy(repr.begin(), repr.end(), repr_tasks + i * num_tasks);
+           }
+
+           return std::make_tuple(reprs, orbits_new, orbit_indices);
+         },
+         "mappings"_a, "representatives"_a, "method"_a = "auto", "num_threads"_a = 1u, "timeout"_a = 0.0);
 
   // ArchGraphAutomorphisms
   py::class_<ArchGraphAutomorphisms,
@@ -606,6 +745,8 @@ PYBIND11_MODULE_(PYTHON_MODULE_INTERNAL, m)
   // TMORs
   py::class_<TMORs>(m, "Representatives")
     .def(py::init<>())
+    .def_static("mapped", &TMORs::mapped,
+                "file"_a, "mapping_size"_a, "max_task"_a, "capacity"_a)
     .def(py::self == py::self)
     .def(py::self != py::self)
     .def("__len__", &TMORs::num_orbits)
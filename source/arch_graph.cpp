@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <fstream>
 #include <map>
 #include <memory>
@@ -123,12 +124,25 @@ void ArchGraph::add_channel(unsigned from, unsigned to, ChannelType ct)
   if (channel_exists(from, to, ct))
     return;
 
+  // if the new channel is fixed by all automorphisms of the extended graph,
+  // these are exactly the previous automorphisms fixing the channel
+  bool incremental = automorphisms_ready() && !directed();
+
+  PermGroup automorphisms_previous;
+  if (incremental)
+    automorphisms_previous = automorphisms();
+
   reset_automorphisms();
 
   _channel_type_instances[ct]++;
 
   EdgeProperty ep {ct};
   boost::add_edge(from, to, ep, _adj);
+
+  if (incremental && channel_fixed(from, to, ct)) {
+    update_automorphisms(automorphisms_previous.setwise_stabilizer(
+      from, to, automorphisms_options()));
+  }
 }
 
 void ArchGraph::add_channel(unsigned pe1, unsigned pe2, std::string const &cl)
@@ -256,4 +270,83 @@ bool ArchGraph::channel_exists_undirected(unsigned from, unsigned to, ChannelTyp
          channel_exists_directed(to, from, ct);
 }
 
+bool ArchGraph::channel_fixed(unsigned from, unsigned to, ChannelType ct) const
+{
+  unsigned n = num_processors();
+
+  std::vector<std::vector<std::pair<ChannelType, unsigned>>> neighbours(n);
+
+  for (auto ch : channels()) {
+    neighbours[source(ch)].emplace_back(channel_type(ch), target(ch));
+
+    if (source(ch) != target(ch))
+      neighbours[target(ch)].emplace_back(channel_type(ch), source(ch));
+  }
+
+  // colour refinement starting from the processor types, the final colouring
+  // is preserved by all automorphisms
+  std::vector<unsigned> colours(n);
+  for (auto pe : processors())
+    colours[pe] = static_cast<unsigned>(processor_type(pe));
+
+  std::size_t num_colours = 0u;
+
+  for (;;) {
+    std::map<std::vector<unsigned>, unsigned> signature_colours;
+    std::vector<unsigned> colours_next(n);
+
+    for (unsigned pe = 0u; pe < n; ++pe) {
+      std::vector<std::pair<unsigned, unsigned>> adjacent;
+      for (auto const &neighbour : neighbours[pe]) {
+        adjacent.emplace_back(static_cast<unsigned>(neighbour.first),
+                              colours[neighbour.second]);
+      }
+
+      std::sort(adjacent.begin(), adjacent.end());
+
+      std::vector<unsigned> signature {colours[pe]};
+      for (auto const &a : adjacent) {
+        signature.push_back(a.first);
+        signature.push_back(a.second);
+      }
+
+      auto colour = static_cast<unsigned>(signature_colours.size());
+
+      colours_next[pe] =
+        signature_colours.emplace(signature, colour).first->second;
+    }
+
+    colours.swap(colours_next);
+
+    // refinement only ever splits colour classes
+    if (signature_colours.size() == num_colours)
+      break;
+
+    num_colours = signature_colours.size();
+  }
+
+  // the channel is fixed if no other channel of the same type connects
+  // processors of the same colours
+  auto colour_pair = [&](unsigned pe1, unsigned pe2){
+    return std::make_pair(std::min(colours[pe1], colours[pe2]),
+                          std::max(colours[pe1], colours[pe2]));
+  };
+
+  auto channel_colours(colour_pair(from, to));
+
+  unsigned num_matching = 0u;
+
+  for (auto ch : channels()) {
+    if (channel_type(ch) != ct)
+      continue;
+
+    if (colour_pair(source(ch), target(ch)) == channel_colours &&
+        ++num_matching > 1u) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 } // namespace mpsym
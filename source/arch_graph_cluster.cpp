@@ -1,12 +1,17 @@
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "arch_graph_cluster.hpp"
 #include "arch_graph_system.hpp"
 #include "dump.hpp"
+#include "metrics.hpp"
+#include "parallel.hpp"
 #include "perm_group.hpp"
 #include "perm_set.hpp"
 #include "task_mapping.hpp"
@@ -78,6 +83,13 @@ ArchGraphCluster::automorphisms_(AutomorphismOptions const *options,
 {
   assert(!_subsystems.empty());
 
+  auto distinct(distinct_subsystems());
+
+  util::parallel_for(
+    distinct.size(),
+    AutomorphismOptions::fill_defaults(options).automorphisms_cluster_threads,
+    [&](std::size_t i){ distinct[i]->automorphisms(options, aborted); });
+
   std::vector<PermGroup> automorphisms(_subsystems.size());
   for (auto i = 0u; i < _subsystems.size(); ++i)
     automorphisms[i] = _subsystems[i]->automorphisms(options, aborted);
@@ -88,25 +100,86 @@ ArchGraphCluster::automorphisms_(AutomorphismOptions const *options,
                                    aborted);
 }
 
+void
+ArchGraphCluster::init_repr_(AutomorphismOptions const *options,
+                             timeout::flag aborted)
+{
+  auto distinct(distinct_subsystems());
+
+  util::parallel_for(
+    distinct.size(),
+    AutomorphismOptions::fill_defaults(options).automorphisms_cluster_threads,
+    [&](std::size_t i){
+      if (!distinct[i]->repr_ready())
+        distinct[i]->init_repr(options, aborted);
+    });
+}
+
 TaskMapping
-ArchGraphCluster::repr_(TaskMapping const &mapping_,
+ArchGraphCluster::repr_(TaskMapping const &mapping,
                         ReprOptions const *options_,
                         TMORs *,
                         timeout::flag aborted)
 {
+  METRICS_LATENCY("repr_cluster");
+
   auto options(ReprOptions::fill_defaults(options_));
 
   assert(_subsystems.size() > 0u);
 
-  TaskMapping mapping(mapping_);
+  // subsystems act on disjoint processor ranges, so their representatives
+  // can be determined independently from the original mapping
+  std::vector<unsigned> offsets(_subsystems.size() + 1u);
+
+  offsets[0] = options.offset;
+  for (auto i = 0u; i < _subsystems.size(); ++i)
+    offsets[i + 1u] = offsets[i] + _subsystems[i]->num_processors();
+
+  if (util::num_threads(options.cluster_threads) > 1u)
+    prepare_repr_(&options);
+
+  std::vector<TaskMapping> representatives(_subsystems.size());
+
+  util::parallel_for(
+    _subsystems.size(),
+    options.cluster_threads,
+    [&](std::size_t i){
+      auto subsystem_options(options);
+      subsystem_options.offset = offsets[i];
 
-  for (auto i = 0u; i < _subsystems.size(); ++i) {
-    mapping = _subsystems[i]->repr(mapping, &options, aborted);
+      representatives[i] =
+        _subsystems[i]->repr(mapping, &subsystem_options, aborted);
+    },
+    1u);
 
-    options.offset += _subsystems[i]->num_processors();
+  // every task is taken from the representative of the subsystem containing
+  // the processor it was originally mapped to
+  TaskMapping representative(mapping);
+
+  for (auto j = 0u; j < mapping.size(); ++j) {
+    auto it(std::upper_bound(offsets.begin(), offsets.end(), mapping[j]));
+
+    if (it == offsets.begin() || it == offsets.end())
+      continue;
+
+    representative[j] = representatives[it - offsets.begin() - 1u][j];
+  }
+
+  return representative;
+}
+
+std::vector<std::shared_ptr<ArchGraphSystem>>
+ArchGraphCluster::distinct_subsystems() const
+{
+  std::vector<std::shared_ptr<ArchGraphSystem>> res;
+  std::unordered_set<ArchGraphSystem *> seen;
+
+  for (auto const &subsystem : _subsystems) {
+    if (seen.insert(subsystem.get()).second)
+      res.push_back(subsystem);
   }
 
-  return mapping;
+  return res;
 }
 
 } // namespace mpsym
@@ -9,6 +9,7 @@ extern "C" {
 }
 
 #include "arch_graph.hpp"
+#include "metrics.hpp"
 #include "nauty_graph.hpp"
 #include "perm_group.hpp"
 
@@ -76,9 +77,15 @@ std::string ArchGraph::to_gap_nauty() const
 
 PermSet ArchGraph::automorphism_generators_nauty()
 {
+  METRICS_LATENCY("nauty");
+
   auto g(graph_nauty());
 
-  return g.automorphism_generators();
+  auto generators(g.automorphism_generators());
+
+  METRICS_COUNTER_ADD("nauty_generators", generators.size());
+
+  return generators;
 }
 
 PermGroup ArchGraph::automorphisms_nauty(AutomorphismOptions const *options,
@@ -1,6 +1,7 @@
 #include <algorithm>
 #include <atomic>
 #include <cmath>
+#include <cstddef>
 #include <functional>
 #include <limits>
 #include <memory>
@@ -9,6 +10,7 @@
 #include <queue>
 #include <random>
 #include <stdexcept>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -20,9 +22,14 @@
 #include "arch_graph_system.hpp"
 #include "arch_uniform_super_graph.hpp"
 #include "bsgs.hpp"
+#include "bsgs_cache.hpp"
+#include "metrics.hpp"
+#include "orbit.hpp"
+#include "parallel.hpp"
 #include "perm.hpp"
 #include "perm_group.hpp"
 #include "perm_set.hpp"
+#include "sparse_perm.hpp"
 #include "task_mapping.hpp"
 #include "task_mapping_orbit.hpp"
 #include "timeout.hpp"
@@ -80,6 +87,89 @@ TMO ArchGraphSystem::automorphisms_orbit(
   return TMO(mapping, _automorphism_generators.with_inverses());
 }
 
+std::vector<TaskMapping> ArchGraphSystem::repr_batch(
+  TaskMapping const *mappings,
+  std::size_t num_mappings,
+  ReprOptions const *options,
+  unsigned num_threads,
+  timeout::flag aborted)
+{
+  std::vector<TaskMapping> representatives(num_mappings);
+
+  if (num_mappings == 0u)
+    return representatives;
+
+  init_repr(nullptr, aborted);
+  prepare_repr(options);
+
+  util::parallel_for(
+    num_mappings,
+    num_threads,
+    [&](std::size_t i){
+      representatives[i] = repr_(mappings[i], options, nullptr, aborted);
+    });
+
+  return representatives;
+}
+
+std::vector<std::tuple<TaskMapping, bool, unsigned>>
+ArchGraphSystem::repr_batch(
+  TaskMapping const *mappings,
+  std::size_t num_mappings,
+  TMORs &orbits,
+  ReprOptions const *options,
+  unsigned num_threads,
+  timeout::flag aborted)
+{
+  std::vector<std::tuple<TaskMapping, bool, unsigned>> res(num_mappings);
+
+  if (num_mappings == 0u)
+    return res;
+
+  init_repr(nullptr, aborted);
+  prepare_repr(options);
+
+  // orbits is shared between workers, so that representatives found by one
+  // worker allow other workers to terminate early
+  util::parallel_for(
+    num_mappings,
+    num_threads,
+    [&](std::size_t i){
+      auto representative(repr_(mappings[i], options, &orbits, aborted));
+
+      auto ins(orbits.insert(representative));
+
+      res[i] = std::make_tuple(
+        std::move(representative), ins.first, ins.second);
+    });
+
+  return res;
+}
+
+PermGroup ArchGraphSystem::automorphisms_cached(
+  AutomorphismOptions const *options,
+  timeout::flag aborted)
+{
+  if (!options || options->automorphisms_cache_directory.empty())
+    return automorphisms_(options, aborted);
+
+  BSGSCache cache(options->automorphisms_cache_directory);
+
+  auto description(to_json());
+
+  BSGS bsgs;
+  if (cache.load(description, bsgs, options) &&
+      bsgs.degree() == automorphisms_degree()) {
+    return PermGroup(bsgs);
+  }
+
+  auto automorphisms(automorphisms_(options, aborted));
+
+  cache.store(description, automorphisms.bsgs());
+
+  return automorphisms;
+}
+
 bool ArchGraphSystem::automorphisms_symmetric(ReprOptions const *options)
 {
   TaskMapping representative;
@@ -98,12 +188,29 @@ bool ArchGraphSystem::automorphisms_symmetric(ReprOptions const *options)
   return options->optimize_symmetric && _automorphisms_is_symmetric;
 }
 
+void ArchGraphSystem::prepare_repr_(ReprOptions const *options_)
+{
+  if (!automorphisms_ready())
+    automorphisms();
+
+  auto options(ReprOptions::fill_defaults(options_));
+
+  if (_automorphisms.is_trivial() || automorphisms_symmetric(&options))
+    return;
+
+  if ((options.method == ReprOptions::Method::ITERATE ||
+       options.method == ReprOptions::Method::BACKTRACK) &&
+      !_automorphisms_chain_valid) {
+    init_automorphisms_chain();
+  }
+}
+
 TaskMapping ArchGraphSystem::repr_(TaskMapping const &mapping,
                                    ReprOptions const *options_,
                                    TMORs *orbits,
                                    timeout::flag aborted)
 {
-  automorphisms();
+  prepare_repr_(options_);
 
   auto options(ReprOptions::fill_defaults(options_));
 
@@ -115,6 +222,8 @@ TaskMapping ArchGraphSystem::repr_(TaskMapping const &mapping,
 
   return options.method == ReprOptions::Method::ITERATE ?
            min_elem_iterate(mapping, &options, orbits, aborted) :
+         options.method == ReprOptions::Method::BACKTRACK ?
+           min_elem_backtrack(mapping, &options, orbits, aborted) :
          options.method == ReprOptions::Method::ORBITS ?
            min_elem_orbits(mapping, &options, orbits, aborted) :
          options.method == ReprOptions::Method::LOCAL_SEARCH ?
@@ -129,36 +238,316 @@ TaskMapping ArchGraphSystem::min_elem_iterate(TaskMapping const &tasks,
                                               TMORs *orbits,
                                               timeout::flag aborted) const
 {
+  METRICS_LATENCY("repr_iterate");
+
   TaskMapping representative(tasks);
 
-  for (auto it = _automorphisms.begin(); it != _automorphisms.end(); ++it) {
-    if (timeout::is_set(aborted))
-      throw timeout::AbortedError("min_elem_iterate");
+  if (is_repr(representative, options, orbits))
+    return representative;
+
+  // task_images[i] holds the images of the tasks under the product of the
+  // inverses of the transversal elements chosen on the first i levels, the
+  // inverses of all group elements are exactly the group elements and
+  // applying them in this order means that only the images of the tasks
+  // themselves ever have to be computed
+  std::vector<TaskMapping> task_images(_automorphisms_chain.size(), tasks);
+
+  min_elem_iterate_level(0u,
+                         representative,
+                         task_images,
+                         options,
+                         orbits,
+                         aborted);
+
+  return representative;
+}
+
+bool ArchGraphSystem::min_elem_iterate_level(
+  unsigned level,
+  TaskMapping &representative,
+  std::vector<TaskMapping> &task_images,
+  ReprOptions const *options,
+  TMORs *orbits,
+  timeout::flag aborted) const
+{
+  if (timeout::is_set(aborted))
+    throw timeout::AbortedError("min_elem_iterate");
+
+  auto const &chain_level(_automorphisms_chain[level]);
+
+  TaskMapping const &current(task_images[level]);
+
+  unsigned offset = options->offset;
+  unsigned degree = _automorphisms.degree();
+
+  // the remaining factors lie in the stabilizer of the first level base
+  // points, so a task image is only fixed from here on if it lies in a trivial
+  // orbit of that stabilizer and can otherwise at best become its orbit's
+  // smallest element, skip the subtree if that can not beat the representative
+  bool smaller = false;
+
+  for (unsigned i = 0u; i < current.size(); ++i) {
+    unsigned task = current[i];
+    if (task < offset || task >= offset + degree)
+      continue;
+
+    int orbit_index = chain_level.orbit_indices[task - offset];
+
+    bool fixed = orbit_index == -1 ||
+                 chain_level.orbits[orbit_index].size() == 1u;
+
+    unsigned bound = fixed ? task :
+                             chain_level.orbit_mins[orbit_index] + offset;
+
+    if (bound > representative[i])
+      return false;
+
+    if (bound < representative[i]) {
+      smaller = fixed;
+      break;
+    }
+
+    if (!fixed)
+      break;
+  }
+
+  if (level + 1u == _automorphisms_chain.size()) {
+    if (!smaller)
+      return false;
+
+    representative = current;
+
+    return is_repr(representative, options, orbits);
+  }
+
+  TaskMapping &next(task_images[level + 1u]);
+
+  for (Perm const &transversal_inverse : chain_level.transversal_inverses) {
+    for (unsigned i = 0u; i < current.size(); ++i) {
+      unsigned task = current[i];
+      if (task >= offset && task < offset + degree)
+        next[i] = transversal_inverse[task - offset] + offset;
+    }
+
+    if (min_elem_iterate_level(level + 1u,
+                               representative,
+                               task_images,
+                               options,
+                               orbits,
+                               aborted)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void ArchGraphSystem::init_automorphisms_chain()
+{
+  auto const &bsgs(_automorphisms.bsgs());
+
+  _automorphisms_chain.clear();
+  _automorphisms_chain.resize(bsgs.base_size() + 1u);
+
+  for (unsigned i = 0u; i <= bsgs.base_size(); ++i) {
+    auto &level(_automorphisms_chain[i]);
 
-    auto const &factors(it.factors());
+    if (i < bsgs.base_size()) {
+      auto transversals(bsgs.transversals(i));
+      level.transversals.assign(transversals.begin(), transversals.end());
 
-    if (tasks.less_than(representative, factors, options->offset))
-      representative = tasks.permuted(factors, options->offset);
+      for (Perm const &transversal : level.transversals)
+        level.transversal_inverses.push_back(~transversal);
+    }
+
+    OrbitPartition orbits(bsgs.degree(), bsgs.strong_generators(i));
+
+    level.orbit_indices.resize(bsgs.degree());
+    for (unsigned x = 0u; x < bsgs.degree(); ++x)
+      level.orbit_indices[x] = orbits.partition_index(x);
 
-    if (is_repr(representative, options, orbits)) {
-      return representative;
+    for (auto const &orbit : orbits) {
+      level.orbits.emplace_back(orbit.begin(), orbit.end());
+      level.orbit_mins.push_back(
+        *std::min_element(level.orbits.back().begin(),
+                          level.orbits.back().end()));
     }
   }
 
+  _automorphisms_chain_valid = true;
+}
+
+TaskMapping ArchGraphSystem::min_elem_backtrack(TaskMapping const &tasks,
+                                                ReprOptions const *options,
+                                                TMORs *orbits,
+                                                timeout::flag aborted) const
+{
+  METRICS_LATENCY("repr_backtrack");
+
+  TaskMapping representative(tasks);
+
+  // partial_products[i] is the product of the transversal elements chosen on
+  // the first i levels of the stabilizer chain
+  std::vector<Perm> partial_products(_automorphisms_chain.size(),
+                                     Perm(_automorphisms.degree()));
+
+  min_elem_backtrack_level(0u,
+                           tasks,
+                           representative,
+                           partial_products,
+                           options,
+                           orbits,
+                           aborted);
+
   return representative;
 }
 
+bool ArchGraphSystem::min_elem_backtrack_level(
+  unsigned level,
+  TaskMapping const &tasks,
+  TaskMapping &representative,
+  std::vector<Perm> &partial_products,
+  ReprOptions const *options,
+  TMORs *orbits,
+  timeout::flag aborted) const
+{
+  if (timeout::is_set(aborted))
+    throw timeout::AbortedError("min_elem_backtrack");
+
+  Perm const &partial_product = partial_products[level];
+
+  // complete group element which has not been pruned, i.e. which maps the
+  // tasks to a smaller task mapping than the current representative
+  if (level + 1u == _automorphisms_chain.size()) {
+    representative = tasks.permuted(partial_product, options->offset);
+
+    return is_repr(representative, options, orbits);
+  }
+
+  auto const &transversals(_automorphisms_chain[level].transversals);
+
+  // visit cosets in order of the bound on the image of the first task that is
+  // moved by the automorphisms so that small representatives are found early
+  unsigned first_task = tasks.size();
+  for (unsigned i = 0u; i < tasks.size(); ++i) {
+    if (tasks[i] >= options->offset &&
+        tasks[i] < options->offset + _automorphisms.degree()) {
+      first_task = i;
+      break;
+    }
+  }
+
+  std::vector<Perm> children;
+  children.reserve(transversals.size());
+
+  std::vector<std::pair<unsigned, unsigned>> children_order;
+  children_order.reserve(transversals.size());
+
+  for (unsigned j = 0u; j < transversals.size(); ++j) {
+    children.push_back(transversals[j] * partial_product);
+
+    unsigned bound = first_task == tasks.size() ? 0u :
+      min_elem_backtrack_bound(level + 1u,
+                               tasks[first_task] - options->offset,
+                               children.back()).first;
+
+    children_order.emplace_back(bound, j);
+  }
+
+  std::sort(children_order.begin(), children_order.end());
+
+  for (auto const &child : children_order) {
+    partial_products[level + 1u] = children[child.second];
+
+    if (min_elem_backtrack_prune(level + 1u,
+                                 tasks,
+                                 representative,
+                                 partial_products[level + 1u],
+                                 options->offset)) {
+      continue;
+    }
+
+    if (min_elem_backtrack_level(level + 1u,
+                                 tasks,
+                                 representative,
+                                 partial_products,
+                                 options,
+                                 orbits,
+                                 aborted)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+std::pair<unsigned, bool> ArchGraphSystem::min_elem_backtrack_bound(
+  unsigned level,
+  unsigned x,
+  Perm const &partial_product) const
+{
+  // the remaining factors lie in the stabilizer of the first level base
+  // points, so x can be mapped to partial_product[y] for every y in the orbit
+  // of x under that stabilizer
+  auto const &chain_level(_automorphisms_chain[level]);
+
+  int orbit_index = chain_level.orbit_indices[x];
+
+  if (orbit_index == -1 || chain_level.orbits[orbit_index].size() == 1u)
+    return std::make_pair(partial_product[x], true);
+
+  unsigned bound = partial_product[x];
+  for (unsigned y : chain_level.orbits[orbit_index])
+    bound = std::min(bound, partial_product[y]);
+
+  return std::make_pair(bound, false);
+}
+
+bool ArchGraphSystem::min_elem_backtrack_prune(
+  unsigned level,
+  TaskMapping const &tasks,
+  TaskMapping const &representative,
+  Perm const &partial_product,
+  unsigned offset) const
+{
+  for (unsigned i = 0u; i < tasks.size(); ++i) {
+    unsigned task = tasks[i];
+    if (task < offset || task >= offset + partial_product.degree())
+      continue;
+
+    auto bound(min_elem_backtrack_bound(level, task - offset, partial_product));
+
+    unsigned task_bound = bound.first + offset;
+
+    if (task_bound < representative[i])
+      return false;
+
+    if (task_bound > representative[i])
+      return true;
+
+    if (!bound.second)
+      return false;
+  }
+
+  // all task images are determined and equal to the current representative
+  return true;
+}
+
 TaskMapping ArchGraphSystem::min_elem_orbits(TaskMapping const &tasks,
                                              ReprOptions const *options,
                                              TMORs *orbits,
                                              timeout::flag aborted) const
 {
+  METRICS_LATENCY("repr_orbits");
+
   TaskMapping representative(tasks);
 
   std::unordered_set<TaskMapping> unprocessed, processed;
 
   unprocessed.insert(tasks);
 
+  TaskMappingIndex index;
+
   while (!unprocessed.empty()) {
     if (timeout::is_set(aborted))
       throw timeout::AbortedError("min_elem_orbits");
@@ -172,8 +561,25 @@ TaskMapping ArchGraphSystem::min_elem_orbits(TaskMapping const &tasks,
     if (current.less_than(representative))
       representative = current;
 
-    for (Perm const &gen : _automorphism_generators) {
-      TaskMapping next(current.permuted(gen, options->offset));
+    // the index is only built if some generator moves fewer points than there
+    // are tasks, all other generators are applied to every task directly
+    bool indexed = false;
+
+    for (unsigned i = 0u; i < _automorphism_generators.size(); ++i) {
+      auto const &gen_sparse(_automorphism_generators_sparse[i]);
+
+      TaskMapping next;
+
+      if (current.permute_sparsely(gen_sparse)) {
+        if (!indexed) {
+          index.reset(current, options->offset, _automorphisms.degree());
+          indexed = true;
+        }
+
+        next = current.permuted(gen_sparse, index, options->offset);
+      } else {
+        next = current.permuted(_automorphism_generators[i], options->offset);
+      }
 
       if (is_repr(next, options, orbits))
         return next;
@@ -189,27 +595,65 @@ TaskMapping ArchGraphSystem::min_elem_local_search(
   TaskMapping const &tasks,
   ReprOptions const *options) const
 {
+  METRICS_LATENCY("repr_local_search");
+
   auto generators(local_search_augment_gens(options));
 
+  // sparse forms of the appended random generators
+  unsigned num_automorphism_generators = _automorphism_generators.size();
+
+  std::vector<SparsePerm> generators_sparse_appended;
+  for (unsigned i = num_automorphism_generators; i < generators.size(); ++i)
+    generators_sparse_appended.emplace_back(generators[i]);
+
   TaskMapping representative(tasks);
 
+  // the index is only (re)built if a generator moves fewer points than there
+  // are tasks, it is kept up to date by permuting it alongside the
+  // representative by such generators
+  TaskMappingIndex index;
+  bool indexed = false;
+
   std::vector<TaskMapping> possible_representatives;
   possible_representatives.reserve(generators.size());
 
   for (;;) {
     bool stationary = true;
 
-    for (Perm const &gen : generators) {
-      if (representative.less_than(representative, gen, options->offset)) {
-        if (options->variant == ReprOptions::Variant::LOCAL_SEARCH_BFS) {
-          possible_representatives.push_back(
-            representative.permuted(gen, options->offset));
-        } else {
-          representative.permute(gen, options->offset);
-        }
+    for (unsigned i = 0u; i < generators.size(); ++i) {
+      auto const &gen(generators[i]);
+      auto const &gen_sparse(
+        i < num_automorphism_generators ?
+          _automorphism_generators_sparse[i] :
+          generators_sparse_appended[i - num_automorphism_generators]);
+
+      bool sparse = representative.permute_sparsely(gen_sparse);
+
+      if (sparse && !indexed) {
+        index.reset(representative, options->offset, _automorphisms.degree());
+        indexed = true;
+      }
 
-        stationary = false;
+      bool less = sparse ?
+        representative.permuted_less_than(gen_sparse, index, options->offset) :
+        representative.less_than(representative, gen, options->offset);
+
+      if (!less)
+        continue;
+
+      if (options->variant == ReprOptions::Variant::LOCAL_SEARCH_BFS) {
+        possible_representatives.push_back(
+          sparse ? representative.permuted(gen_sparse, index, options->offset)
+                 : representative.permuted(gen, options->offset));
+      } else if (sparse) {
+        representative.permute(gen_sparse, index, options->offset);
+        index.permute(gen_sparse);
+      } else {
+        representative.permute(gen, options->offset);
+        indexed = false;
       }
+
+      stationary = false;
     }
 
     if (stationary)
@@ -222,6 +666,8 @@ TaskMapping ArchGraphSystem::min_elem_local_search(
                                             TaskMapping const &rhs)
                                          { return lhs.less_than(rhs); });
 
+      indexed = false;
+
       possible_representatives.clear();
     }
   }
@@ -245,10 +691,12 @@ TaskMapping ArchGraphSystem::min_elem_local_search_sa(
   TaskMapping const &tasks,
   ReprOptions const *options) const
 {
+  METRICS_LATENCY("repr_local_search_sa");
+
   using namespace std::placeholders;
 
   // probability distributions
-  static auto re(util::random_engine());
+  static thread_local auto re(util::random_engine());
 
   std::uniform_real_distribution<> d_prob(0.0, 1.0);
 
@@ -337,6 +785,8 @@ TaskMapping ArchGraphSystem::min_elem_symmetric(
   TaskMapping const &tasks,
   ReprOptions const *options) const
 {
+  METRICS_LATENCY("repr_symmetric");
+
   TaskMapping representative(tasks);
 
   auto support(_automorphisms.support());
@@ -1,12 +1,11 @@
 #include <memory>
-#include <numeric>
 #include <sstream>
 #include <string>
 #include <vector>
 
-#include "arch_graph_automorphisms.hpp"
 #include "arch_graph_system.hpp"
 #include "arch_uniform_super_graph.hpp"
+#include "metrics.hpp"
 #include "perm.hpp"
 #include "perm_group.hpp"
 #include "perm_set.hpp"
@@ -69,75 +68,6 @@ ArchUniformSuperGraph::num_channels() const
   return inter_channels + intra_channels;
 }
 
-std::shared_ptr<ArchGraphAutomorphisms>
-ArchUniformSuperGraph::wreath_product_action_super_graph(
-  AutomorphismOptions const *options,
-  timeout::flag aborted) const
-{
-  auto automs_super_graph(_subsystem_super_graph->automorphisms());
-
-  unsigned degree_super_graph = _subsystem_super_graph->num_processors();
-  unsigned degree_proto = _subsystem_proto->num_processors();
-  unsigned degree = degree_super_graph * degree_proto;
-
-  PermSet sigma_super_graph_gens;
-
-  for (auto const &gen_ : automs_super_graph.generators()) {
-    std::vector<unsigned> gen(degree);
-
-    for (unsigned i = 0u; i < gen.size(); ++i) {
-      unsigned block_from = i / degree_proto;
-      unsigned block_offs = i % degree_proto;
-
-      gen[i] = gen_[block_from] * degree_proto + block_offs;
-    }
-
-    sigma_super_graph_gens.insert(Perm(gen));
-  }
-
-  PermGroup pg(BSGS(degree, sigma_super_graph_gens, options, aborted));
-
-  return std::make_shared<ArchGraphAutomorphisms>(pg);
-}
-
-std::vector<std::shared_ptr<ArchGraphAutomorphisms>>
-ArchUniformSuperGraph::wreath_product_action_proto(
-  AutomorphismOptions const *options,
-  timeout::flag aborted) const
-{
-  auto automs_proto(_subsystem_proto->automorphisms());
-
-  unsigned degree_super_graph = _subsystem_super_graph->num_processors();
-  unsigned degree_proto = _subsystem_proto->num_processors();
-  unsigned degree = degree_super_graph * degree_proto;
-
-  std::vector<PermSet> sigmas_proto_gens(degree_super_graph);
-
-  for (auto const &gen_ : automs_proto.generators()) {
-    for (unsigned b = 0u; b < sigmas_proto_gens.size(); ++b) {
-      std::vector<unsigned> gen(degree);
-      std::iota(gen.begin(), gen.end(), 0u);
-
-      unsigned block_end = (b + 1u) * degree_proto;
-      unsigned block_start = block_end - degree_proto + 1u;
-
-      for (unsigned j = block_start; j <= block_end; ++j)
-        gen[j - 1u] = gen_[(j - 1u) % degree_proto] + block_start - 1u;
-
-      sigmas_proto_gens[b].insert(Perm(gen));
-    }
-  }
-
-  std::vector<std::shared_ptr<ArchGraphAutomorphisms>> sigmas_proto;
-  for (auto const &gens : sigmas_proto_gens) {
-    PermGroup pg(BSGS(degree, gens, options, aborted));
-
-    sigmas_proto.push_back(std::make_shared<ArchGraphAutomorphisms>(pg));
-  }
-
-  return sigmas_proto;
-}
-
 PermGroup
 ArchUniformSuperGraph::automorphisms_(AutomorphismOptions const *options,
                                       timeout::flag aborted)
@@ -153,31 +83,36 @@ void
 ArchUniformSuperGraph::init_repr_(AutomorphismOptions const *options,
                                   timeout::flag aborted)
 {
-  auto automs_super_graph(
-    _subsystem_super_graph->automorphisms(options, aborted));
+  _subsystem_super_graph->init_repr(options, aborted);
+  _subsystem_proto->init_repr(options, aborted);
+
+  _super_graph_trivial =
+    _subsystem_super_graph->automorphisms(options, aborted).is_trivial();
 
-  auto automs_proto(
-    _subsystem_proto->automorphisms(options, aborted));
+  _proto_trivial =
+    _subsystem_proto->automorphisms(options, aborted).is_trivial();
 
-  _super_graph_trivial = automs_super_graph.is_trivial();
-  _proto_trivial = automs_proto.is_trivial();
+  // in that case the prototype automorphisms act on all blocks simultaneously
+  // (see PermGroup::wreath_product) so blocks can not be treated separately
+  if (_super_graph_trivial) {
+    _sigma_total = std::make_shared<ArchGraphAutomorphisms>(
+      automorphisms(options, aborted));
 
-  if (_super_graph_trivial || _proto_trivial) {
-    _sigma_total = std::make_shared<ArchGraphAutomorphisms>(automorphisms(options, aborted));
+    _sigma_total->init_repr(options, aborted);
   } else {
-    _sigma_super_graph = wreath_product_action_super_graph(options, aborted);
-    _sigmas_proto = wreath_product_action_proto(options, aborted);
+    _sigma_total.reset();
   }
 
-  _sigmas_valid = true;
+  _repr_valid = true;
 }
 
 bool
 ArchUniformSuperGraph::repr_ready_() const
 {
-  return _subsystem_super_graph->automorphisms_ready() &&
-         _subsystem_proto->automorphisms_ready() &&
-         _sigmas_valid;
+  return _subsystem_super_graph->repr_ready() &&
+         _subsystem_proto->repr_ready() &&
+         _repr_valid &&
+         (!_sigma_total || _sigma_total->repr_ready());
 }
 
 void
@@ -185,24 +120,108 @@ ArchUniformSuperGraph::reset_repr_()
 {
   _subsystem_super_graph->reset_automorphisms();
   _subsystem_proto->reset_automorphisms();
-  _sigmas_valid = false;
+  _sigma_total.reset();
+  _repr_valid = false;
+}
+
+void
+ArchUniformSuperGraph::prepare_repr_(ReprOptions const *options)
+{
+  if (_sigma_total) {
+    _sigma_total->prepare_repr(options);
+    return;
+  }
+
+  _subsystem_super_graph->prepare_repr(options);
+  _subsystem_proto->prepare_repr(options);
 }
 
 TaskMapping
 ArchUniformSuperGraph::repr_(TaskMapping const &mapping,
-                             ReprOptions const *options,
+                             ReprOptions const *options_,
                              TMORs *,
                              timeout::flag aborted)
 {
+  METRICS_LATENCY("repr_uniform_super_graph");
+
+  if (_sigma_total)
+    return _sigma_total->repr(mapping, options_, aborted);
+
+  auto options(ReprOptions::fill_defaults(options_));
+
+  unsigned offset = options.offset;
+  unsigned degree_super_graph = _subsystem_super_graph->num_processors();
+  unsigned degree_proto = _subsystem_proto->num_processors();
+  unsigned degree = degree_super_graph * degree_proto;
+
+  // the subsystems only see the block (offset) of every task
+  auto subsystem_options(options);
+  subsystem_options.offset = 0u;
+
   TaskMapping representative(mapping);
 
-  if (_super_graph_trivial || _proto_trivial)
-    return _sigma_total->repr(representative, options, aborted);
+  // since the super graph automorphisms are not trivial, the prototype
+  // automorphisms act on every block independently and only reorder tasks
+  // within that block, so the lexicographically smallest mapping results from
+  // minimizing the tasks mapped to every block separately (provided that the
+  // subsystems' repr methods are exact)
+  if (!_proto_trivial) {
+    std::vector<TaskMapping> blocks(degree_super_graph);
+    std::vector<std::vector<unsigned>> block_positions(degree_super_graph);
+
+    for (unsigned i = 0u; i < mapping.size(); ++i) {
+      unsigned task = mapping[i];
+      if (task < offset || task >= offset + degree)
+        continue;
 
-  for (auto &sigma : _sigmas_proto)
-    representative = sigma->repr(representative, options, aborted);
+      unsigned block = (task - offset) / degree_proto;
+
+      blocks[block].push_back((task - offset) % degree_proto);
+      block_positions[block].push_back(i);
+    }
+
+    for (unsigned b = 0u; b < degree_super_graph; ++b) {
+      if (blocks[b].empty())
+        continue;
+
+      auto block_representative(
+        _subsystem_proto->repr(blocks[b], &subsystem_options, aborted));
+
+      for (unsigned j = 0u; j < block_representative.size(); ++j) {
+        representative[block_positions[b][j]] =
+          offset + b * degree_proto + block_representative[j];
+      }
+    }
+  }
+
+  // the super graph automorphisms permute whole blocks, comparing two such
+  // images of a mapping lexicographically is the same as comparing the
+  // sequences of blocks the tasks are mapped to
+  if (!_super_graph_trivial) {
+    TaskMapping blocks;
+    std::vector<unsigned> positions;
+
+    for (unsigned i = 0u; i < representative.size(); ++i) {
+      unsigned task = representative[i];
+      if (task < offset || task >= offset + degree)
+        continue;
+
+      blocks.push_back((task - offset) / degree_proto);
+      positions.push_back(i);
+    }
+
+    auto blocks_representative(
+      _subsystem_super_graph->repr(blocks, &subsystem_options, aborted));
+
+    for (unsigned j = 0u; j < blocks_representative.size(); ++j) {
+      unsigned &task = representative[positions[j]];
+
+      task = offset + blocks_representative[j] * degree_proto
+                    + (task - offset) % degree_proto;
+    }
+  }
 
-  return _sigma_super_graph->repr(representative, options, aborted);
+  return representative;
 }
 
 } // namespace mpsym
@@ -1,6 +1,7 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cstddef>
 #include <iterator>
 #include <memory>
 #include <numeric>
@@ -16,10 +17,13 @@
 #include "orbit.hpp"
 #include "perm.hpp"
 #include "perm_set.hpp"
+#include "perm_word.hpp"
 #include "pr_randomizer.hpp"
 #include "explicit_transversals.hpp"
+#include "metrics.hpp"
 #include "schreier_structure.hpp"
 #include "schreier_tree.hpp"
+#include "schreier_vector.hpp"
 
 namespace mpsym
 {
@@ -45,8 +49,10 @@ void BSGSTransversalsBase::update_schreier_structure(
 
   Orbit::generate(root, generators, ss);
 
-  if (i < _schreier_structures.size())
+  if (i < _schreier_structures.size()) {
     _schreier_structures[i].swap(ss);
+    return;
+  }
 
   assert(i == _schreier_structures.size());
 
@@ -61,6 +67,15 @@ void BSGSTransversalsBase::insert_schreier_structure(
   update_schreier_structure(i, root, degree, generators);
 }
 
+BSGSCachedSchreierTrees::BSGSCachedSchreierTrees(std::size_t cache_limit)
+: _cache(std::make_shared<SchreierTreeCache>(cache_limit))
+{}
+
+std::shared_ptr<SchreierStructure>
+BSGSCachedSchreierTrees::make_schreier_structure(
+  unsigned root, unsigned degree, PermSet const &generators)
+{ return std::make_shared<SchreierTree>(degree, root, generators, _cache); }
+
 BSGS::BSGS(unsigned degree)
 : _degree(degree)
 { assert(degree > 0); }
@@ -128,7 +143,11 @@ BSGS::BSGS(unsigned degree,
 
   auto sgs(strong_generators);
   for (unsigned i = 0; i < base_size(); ++i) {
-    update_schreier_structure(i, sgs);
+    // reduced strong generating sets are not necessarily closed under inversion
+    PermSet tmp(sgs);
+    tmp.insert_inverses();
+
+    update_schreier_structure(i, tmp);
 
     for (auto it = sgs.begin(); it != sgs.end();) {
       if (!it->stabilizes(base_point(i))) {
@@ -187,24 +206,57 @@ PermSet BSGS::stabilizers(unsigned i) const
 
 std::pair<Perm, unsigned> BSGS::strip(Perm const &perm, unsigned offs) const
 {
-  Perm result(perm);
+  std::vector<unsigned> images(perm.vect());
 
-  for (unsigned i = offs; i < base_size(); ++i) {
-    unsigned beta = result[base_point(i)];
-    if (!schreier_structure(i)->contains(beta))
-      return std::make_pair(result, i + 1u);
+  unsigned level = strip_images(images, offs);
 
-    result *= ~schreier_structure(i)->transversal(beta);
-  }
+  return std::make_pair(Perm(images), level);
+}
+
+std::pair<Perm, unsigned> BSGS::strip(PermWord const &word, unsigned offs) const
+{
+  std::vector<unsigned> images(degree());
+  std::iota(images.begin(), images.end(), 0u);
+
+  word.apply(images);
+
+  unsigned level = strip_images(images, offs);
 
-  return std::make_pair(result, base_size() + 1u);
+  return std::make_pair(Perm(images), level);
 }
 
 bool BSGS::strips_completely(Perm const &perm) const
 {
-  auto strip_result(strip(perm));
+  static thread_local std::vector<unsigned> images;
 
-  return strip_result.first.id() && strip_result.second == base_size() + 1u;
+  images = perm.vect();
+
+  if (strip_images(images, 0u) != base_size() + 1u)
+    return false;
+
+  for (unsigned x = 0u; x < degree(); ++x) {
+    if (images[x] != x)
+      return false;
+  }
+
+  return true;
+}
+
+unsigned BSGS::strip_images(std::vector<unsigned> &images, unsigned offs) const
+{
+  METRICS_LATENCY("bsgs_strip");
+
+  // multiplying by the inverse transversals in place avoids both constructing
+  // these inverses and allocating intermediate products
+  for (unsigned i = offs; i < base_size(); ++i) {
+    unsigned beta = images[base_point(i)];
+    if (!schreier_structure(i)->contains(beta))
+      return i + 1u;
+
+    schreier_structure(i)->apply_transversal_inverse(beta, images);
+  }
+
+  return base_size() + 1u;
 }
 
 void BSGS::extend_base(unsigned bp)
@@ -220,10 +272,18 @@ void BSGS::transversals_init(BSGSOptions const *options)
       _transversals = std::make_shared<BSGSTransversals<ExplicitTransversals>>();
       break;
     case BSGSOptions::Transversals::SCHREIER_TREES:
-      _transversals = std::make_shared<BSGSTransversals<SchreierTree>>();
+      if (options->schreier_trees_cache_limit > 0u) {
+        _transversals = std::make_shared<BSGSCachedSchreierTrees>(
+          options->schreier_trees_cache_limit);
+      } else {
+        _transversals = std::make_shared<BSGSTransversals<SchreierTree>>();
+      }
       break;
     case BSGSOptions::Transversals::SHALLOW_SCHREIER_TREES:
       throw std::logic_error("TODO");
+    case BSGSOptions::Transversals::SCHREIER_VECTOR:
+      _transversals = std::make_shared<BSGSTransversals<SchreierVector>>();
+      break;
   }
 }
 
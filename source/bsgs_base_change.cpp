@@ -9,6 +9,7 @@
 #include "orbit.hpp"
 #include "perm.hpp"
 #include "perm_set.hpp"
+#include "perm_word.hpp"
 #include "schreier_generator_queue.hpp"
 #include "schreier_structure.hpp"
 
@@ -111,14 +112,15 @@ void BSGS::swap_base_points(unsigned i)
 
   schreier_generator_queue.update(sgi, oi, schreier_structure(i));
 
-  for (Perm const &perm : schreier_generator_queue) {
+  for (PermWord const &perm : schreier_generator_queue) {
     DBG(TRACE) << "Schreier Generator: " << perm;
 
     if (!schreier_structure(i + 1)->contains(perm[base_point(i + 1u)])) {
       DBG(TRACE) << "Updating strong generators:";
 
-      // extend strong generators
-      sgi1.insert(perm);
+      // extend strong generators (keeping them closed under inversion)
+      sgi1.insert(perm.perm());
+      sgi1.insert(~perm.perm());
       update_schreier_structure(i + 1u, sgi1);
 
       DBG(TRACE) << "S(" << i + 1u << ") = " << stabilizers(i + 1u);
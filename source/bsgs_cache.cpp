@@ -0,0 +1,173 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bsgs.hpp"
+#include "bsgs_cache.hpp"
+#include "dbg.hpp"
+#include "hash.hpp"
+
+namespace
+{
+
+// entries consist of the length of the description, the description itself
+// and the serialized BSGS
+
+bool write_all(int fd, char const *data, std::size_t size)
+{
+  while (size > 0u) {
+    ssize_t written = write(fd, data, size);
+    if (written == -1)
+      return false;
+
+    data += written;
+    size -= static_cast<std::size_t>(written);
+  }
+
+  return true;
+}
+
+} // anonymous namespace
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+BSGSCache::BSGSCache(std::string const &directory)
+: _directory(directory)
+{
+  // failing to create the directory only means that nothing can be stored
+  mkdir(_directory.c_str(), 0755);
+}
+
+std::string BSGSCache::key(std::string const &description)
+{
+  // the description length further reduces the chance of collisions
+  std::stringstream ss;
+
+  ss << std::hex << std::setfill('0') << std::setw(16)
+     << util::stable_hash(description)
+     << "-" << description.size();
+
+  return ss.str();
+}
+
+bool BSGSCache::load(std::string const &description,
+                     BSGS &bsgs,
+                     BSGSOptions const *options) const
+{
+  auto file(path(key(description)));
+
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd == -1)
+    return false;
+
+  struct stat st;
+  if (fstat(fd, &st) == -1 || st.st_size == 0) {
+    close(fd);
+    return false;
+  }
+
+  std::size_t size = static_cast<std::size_t>(st.st_size);
+
+  void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  close(fd);
+
+  if (data == MAP_FAILED)
+    return false;
+
+  auto entry = static_cast<char const *>(data);
+
+  std::uint64_t description_size;
+  std::size_t header_size = sizeof(description_size) + description.size();
+
+  bool success = size >= header_size;
+
+  if (success) {
+    std::memcpy(&description_size, entry, sizeof(description_size));
+
+    success = description_size == description.size() &&
+              std::memcmp(entry + sizeof(description_size),
+                          description.data(),
+                          description.size()) == 0;
+  }
+
+  if (!success) {
+    DBG(WARN) << "Ignoring BSGS cache entry " << file
+              << " stored for a different description";
+  } else {
+    try {
+      bsgs = BSGS::deserialize(entry + header_size,
+                               size - header_size,
+                               options);
+    } catch (std::exception const &e) {
+      DBG(WARN) << "Ignoring corrupted BSGS cache entry " << file
+                << ": " << e.what();
+
+      success = false;
+    }
+  }
+
+  munmap(data, size);
+
+  return success;
+}
+
+bool BSGSCache::store(std::string const &description, BSGS const &bsgs) const
+{
+  auto file(path(key(description)));
+
+  // write to a uniquely named temporary file first and rename it afterwards
+  // so that other threads and processes never observe partially written
+  // entries
+  std::string file_tmp(file + ".tmpXXXXXX");
+
+  int fd = mkstemp(&file_tmp[0]);
+  if (fd == -1)
+    return false;
+
+  std::uint64_t description_size = description.size();
+
+  std::string buf(reinterpret_cast<char const *>(&description_size),
+                  sizeof(description_size));
+
+  buf += description;
+  buf += bsgs.serialize();
+
+  // mkstemp creates files only readable by their owner
+  bool success = fchmod(fd, 0644) == 0 &&
+                 write_all(fd, buf.data(), buf.size());
+
+  if (close(fd) != 0 || !success) {
+    std::remove(file_tmp.c_str());
+    return false;
+  }
+
+  if (std::rename(file_tmp.c_str(), file.c_str()) != 0) {
+    std::remove(file_tmp.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+std::string BSGSCache::path(std::string const &key) const
+{ return _directory + "/" + key + ".bsgs"; }
+
+} // namespace internal
+
+} // namespace mpsym
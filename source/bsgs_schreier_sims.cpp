@@ -1,14 +1,20 @@
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
 #include <memory>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include "bsgs.hpp"
 #include "dbg.hpp"
+#include "metrics.hpp"
 #include "orbit.hpp"
+#include "parallel.hpp"
 #include "perm.hpp"
 #include "perm_set.hpp"
+#include "perm_word.hpp"
 #include "pr_randomizer.hpp"
 #include "schreier_generator_queue.hpp"
 #include "schreier_structure.hpp"
@@ -25,6 +31,8 @@ void BSGS::schreier_sims(PermSet const &generators,
                          BSGSOptions const *options,
                          timeout::flag aborted)
 {
+  METRICS_LATENCY("bsgs_schreier_sims");
+
   DBG(DEBUG) << "Executing Schreier Sims algorithm for:";
   DBG(DEBUG) << generators;
 
@@ -61,7 +69,7 @@ top:
                                             fundamental_orbits[i - 1],
                                             schreier_structure(i - 1));
 
-    for (Perm const &schreier_generator : schreier_generator_queues[i - 1]) {
+    for (PermWord const &schreier_generator : schreier_generator_queues[i - 1]) {
       if (schreier_generator.id())
         continue;
 
@@ -142,6 +150,8 @@ void BSGS::schreier_sims_random(PermSet const &generators,
                                 BSGSOptions const *options,
                                 timeout::flag aborted)
 {
+  METRICS_LATENCY("bsgs_schreier_sims_random");
+
   DBG(TRACE) << "Executing (random) Schreier Sims algorithm";
 
   generators.assert_not_empty();
@@ -200,68 +210,120 @@ void BSGS::schreier_sims_random(std::vector<PermSet> &strong_generators,
                                 BSGSOptions const *options,
                                 timeout::flag aborted)
 {
-  // random group element generator
-  PrRandomizer pr(_strong_generators);
+  unsigned num_threads = util::num_threads(options->schreier_sims_random_threads);
+
+  // independent random group element generators, one per thread
+  std::vector<PrRandomizer> prs;
+  prs.reserve(num_threads);
+
+  for (unsigned t = 0u; t < num_threads; ++t)
+    prs.emplace_back(_strong_generators);
+
+  bool use_known_order = options->schreier_sims_random_use_known_order &&
+                         options->schreier_sims_random_known_order > 0ULL;
 
   unsigned c = 0u;
   while (c < options->schreier_sims_random_w) {
     if (timeout::is_set(aborted))
       throw timeout::AbortedError("schreier_sims_random");
 
-    // generate random group element
-    Perm rand_perm = pr.next();
-    DBG(TRACE) << "Random group element: " << rand_perm;
+    // all threads strip random group elements against the current BSGS until
+    // one of them does not strip completely or the required number of
+    // consecutive group elements stripped completely, the BSGS is not modified
+    // in the meantime
+    std::atomic<unsigned> stripped(c);
+    std::atomic<bool> found(false);
 
-    // strip
-    Perm strip_perm;
-    unsigned strip_level;
+    std::vector<std::pair<Perm, unsigned>> residues(
+      num_threads, std::make_pair(Perm(degree()), 0u));
 
-    std::tie(strip_perm, strip_level) = strip(rand_perm);
+    util::parallel_for(num_threads, num_threads, [&](std::size_t t){
+      while (!found && stripped < options->schreier_sims_random_w) {
+        if (timeout::is_set(aborted))
+          return;
 
-    DBG(TRACE) << "Strips to: " << strip_perm << ", " << strip_level;
+        auto strip_result(strip(prs[t].next()));
 
-    // check whether to update base and strong generators
-    bool update_strong_generators = false;
+        if (strip_result.second <= base_size() || !strip_result.first.id()) {
+          residues[t] = strip_result;
+          found = true;
+          return;
+        }
 
-    if (strip_level <= base_size()) {
-      update_strong_generators = true;
+        ++stripped;
+      }
+    }, 1u);
 
-    } else if (!strip_perm.id()) {
-      update_strong_generators = true;
+    // update the BSGS from the residues in a fixed order, residues obtained
+    // before another residue has updated the BSGS must be stripped again
+    bool updated = false;
 
-      // extend base
-      for (unsigned bp = 0u; bp < degree(); ++bp) {
-        if (strip_perm[bp] != bp) {
-          extend_base(bp);
+    for (auto &residue : residues) {
+      if (residue.second == 0u)
+        continue;
 
-          DBG(TRACE) << "Adjoined new basepoint:";
-          DBG(TRACE) << "B = " << _base;
+      if (updated)
+        residue = strip(residue.first);
 
-          break;
-        }
+      DBG(TRACE) << "Strips to: " << residue.first << ", " << residue.second;
+
+      if (schreier_sims_random_update(residue.first,
+                                      residue.second,
+                                      strong_generators,
+                                      fundamental_orbits)) {
+        updated = true;
       }
     }
 
-    if (update_strong_generators) {
-      DBG(TRACE) << "Updating strong generators:";
-
-      // update strong generators
-      for (unsigned i = 1u; i < strip_level; ++i) {
-        schreier_sims_update_strong_gens(
-          i, {strip_perm}, strong_generators, fundamental_orbits);
-
-        DBG(TRACE) << "S(" << (i + 1u) << ") = " << strong_generators[i];
-        DBG(TRACE) << "O(" << (i + 1u) << ") = " << fundamental_orbits[i];
-      }
+    if (updated) {
+      if (use_known_order && order() == options->schreier_sims_random_known_order)
+        return;
 
       c = 0u;
 
     } else {
-      ++c;
+      c = stripped;
     }
   }
 }
 
+bool BSGS::schreier_sims_random_update(Perm const &strip_perm,
+                                       unsigned strip_level,
+                                       std::vector<PermSet> &strong_generators,
+                                       std::vector<Orbit> &fundamental_orbits)
+{
+  // check whether to update base and strong generators
+  if (strip_level > base_size()) {
+    if (strip_perm.id())
+      return false;
+
+    // extend base
+    for (unsigned bp = 0u; bp < degree(); ++bp) {
+      if (strip_perm[bp] != bp) {
+        extend_base(bp);
+
+        DBG(TRACE) << "Adjoined new basepoint:";
+        DBG(TRACE) << "B = " << _base;
+
+        break;
+      }
+    }
+  }
+
+  DBG(TRACE) << "Updating strong generators:";
+
+  // update strong generators
+  for (unsigned i = 1u; i < strip_level; ++i) {
+    schreier_sims_update_strong_gens(
+      i, {strip_perm}, strong_generators, fundamental_orbits);
+
+    DBG(TRACE) << "S(" << (i + 1u) << ") = " << strong_generators[i];
+    DBG(TRACE) << "O(" << (i + 1u) << ") = " << fundamental_orbits[i];
+  }
+
+  return true;
+}
+
 void BSGS::schreier_sims_init(PermSet const &generators,
                               std::vector<PermSet> &strong_generators,
                               std::vector<Orbit> &fundamental_orbits)
@@ -0,0 +1,211 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "bsgs.hpp"
+#include "perm.hpp"
+#include "perm_set.hpp"
+
+namespace
+{
+
+// layout (all integers are 32 bit and stored in native byte order):
+//
+//   magic, version, flags, degree, width, base size, number of strong
+//   generators, base points, strong generator images (width bytes each)
+char const MAGIC[8] = {'M', 'P', 'S', 'Y', 'M', 'B', 'S', 'G'};
+
+std::uint32_t const VERSION = 1u;
+
+enum : std::uint32_t
+{
+  FLAG_SYMMETRIC = 1u << 0,
+  FLAG_ALTERNATING = 1u << 1
+};
+
+void write_u32(std::string &buf, std::uint32_t val)
+{ buf.append(reinterpret_cast<char const *>(&val), sizeof(val)); }
+
+class Reader
+{
+public:
+  Reader(char const *data, std::size_t size)
+  : _data(data),
+    _size(size),
+    _pos(0u)
+  {}
+
+  void read(void *dest, std::size_t bytes)
+  {
+    if (bytes > _size - _pos)
+      throw std::runtime_error("truncated BSGS data");
+
+    std::memcpy(dest, _data + _pos, bytes);
+    _pos += bytes;
+  }
+
+  std::uint32_t read_u32()
+  {
+    std::uint32_t val;
+    read(&val, sizeof(val));
+    return val;
+  }
+
+  template<typename T>
+  std::vector<unsigned> read_images(unsigned degree)
+  {
+    std::vector<unsigned> images(degree);
+    std::vector<bool> seen(degree, false);
+
+    for (unsigned x = 0u; x < degree; ++x) {
+      T y;
+      read(&y, sizeof(y));
+
+      if (y >= degree || seen[y])
+        throw std::runtime_error("invalid permutation in BSGS data");
+
+      images[x] = y;
+      seen[y] = true;
+    }
+
+    return images;
+  }
+
+  std::size_t remaining() const
+  { return _size - _pos; }
+
+  bool done() const
+  { return _pos == _size; }
+
+private:
+  char const *_data;
+  std::size_t _size;
+  std::size_t _pos;
+};
+
+} // anonymous namespace
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+std::string BSGS::serialize() const
+{
+  std::string buf(MAGIC, sizeof(MAGIC));
+
+  std::uint32_t flags = 0u;
+  if (_is_symmetric)
+    flags |= FLAG_SYMMETRIC;
+  if (_is_alternating)
+    flags |= FLAG_ALTERNATING;
+
+  unsigned width = Perm::width(_degree);
+
+  write_u32(buf, VERSION);
+  write_u32(buf, flags);
+  write_u32(buf, _degree);
+  write_u32(buf, width);
+  write_u32(buf, base_size());
+  write_u32(buf, _strong_generators.size());
+
+  for (unsigned bp : _base)
+    write_u32(buf, bp);
+
+  for (Perm const &perm : _strong_generators) {
+    // permutations of the same degree always have the same width so their
+    // images can be stored as they are
+    switch (width) {
+      case 1u:
+        buf.append(reinterpret_cast<char const *>(perm.data<uint8_t>()),
+                   _degree * width);
+        break;
+      case 2u:
+        buf.append(reinterpret_cast<char const *>(perm.data<uint16_t>()),
+                   _degree * width);
+        break;
+      default:
+        buf.append(reinterpret_cast<char const *>(perm.data<uint32_t>()),
+                   _degree * width);
+    }
+  }
+
+  return buf;
+}
+
+BSGS BSGS::deserialize(char const *data,
+                       std::size_t size,
+                       BSGSOptions const *options)
+{
+  Reader reader(data, size);
+
+  char magic[sizeof(MAGIC)];
+  reader.read(magic, sizeof(magic));
+
+  if (std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+    throw std::runtime_error("not a BSGS");
+
+  if (reader.read_u32() != VERSION)
+    throw std::runtime_error("unsupported BSGS format version");
+
+  std::uint32_t flags = reader.read_u32();
+  std::uint32_t degree = reader.read_u32();
+  std::uint32_t width = reader.read_u32();
+  std::uint32_t base_size = reader.read_u32();
+  std::uint32_t num_strong_generators = reader.read_u32();
+
+  if (degree == 0u || width != Perm::width(degree) || base_size > degree)
+    throw std::runtime_error("invalid BSGS header");
+
+  // check that the header matches the remaining data before allocating any
+  // memory based on it
+  std::uint64_t base_bytes =
+    static_cast<std::uint64_t>(base_size) * sizeof(std::uint32_t);
+  std::uint64_t perm_bytes = static_cast<std::uint64_t>(degree) * width;
+
+  if (reader.remaining() < base_bytes ||
+      (reader.remaining() - base_bytes) % perm_bytes != 0u ||
+      (reader.remaining() - base_bytes) / perm_bytes != num_strong_generators) {
+    throw std::runtime_error("BSGS data size does not match header");
+  }
+
+  Base base(base_size);
+  for (unsigned i = 0u; i < base_size; ++i) {
+    base[i] = reader.read_u32();
+
+    if (base[i] >= degree)
+      throw std::runtime_error("invalid base point in BSGS data");
+  }
+
+  PermSet strong_generators;
+  for (unsigned i = 0u; i < num_strong_generators; ++i) {
+    switch (width) {
+      case 1u:
+        strong_generators.insert(Perm(reader.read_images<uint8_t>(degree)));
+        break;
+      case 2u:
+        strong_generators.insert(Perm(reader.read_images<uint16_t>(degree)));
+        break;
+      default:
+        strong_generators.insert(Perm(reader.read_images<uint32_t>(degree)));
+    }
+  }
+
+  if (!reader.done())
+    throw std::runtime_error("trailing BSGS data");
+
+  BSGS bsgs(degree, base, strong_generators, options);
+
+  bsgs._is_symmetric = flags & FLAG_SYMMETRIC;
+  bsgs._is_alternating = flags & FLAG_ALTERNATING;
+
+  return bsgs;
+}
+
+} // namespace internal
+
+} // namespace mpsym
@@ -2,6 +2,7 @@
 #include <vector>
 
 #include "perm.hpp"
+#include "perm_word.hpp"
 #include "explicit_transversals.hpp"
 
 namespace mpsym
@@ -14,10 +15,10 @@ void ExplicitTransversals::create_edge(
   unsigned origin, unsigned destination, unsigned label)
 {
   if (_orbit.find(destination) == _orbit.end()) {
-    _orbit[destination] = Perm(_degree);
-    _orbit[origin] = _labels[label];
+    _orbit[destination] = PermWord(_degree);
+    _orbit[origin] = PermWord(_labels[label]);
   } else {
-    _orbit[origin] = _orbit[destination] * _labels[label];
+    _orbit[origin] = PermWord(_orbit[destination].perm() * _labels[label]);
   }
 }
 
@@ -54,15 +55,35 @@ Perm ExplicitTransversals::transversal(unsigned origin) const
 {
   auto it(_orbit.find(origin));
 
+  return it->second.perm();
+}
+
+Perm ExplicitTransversals::transversal_inverse(unsigned origin) const
+{
+  return (~transversal_word(origin)).perm();
+}
+
+PermWord ExplicitTransversals::transversal_word(unsigned origin) const
+{
+  auto it(_orbit.find(origin));
+
   return it->second;
 }
 
+void ExplicitTransversals::apply_transversal_inverse(
+  unsigned origin, std::vector<unsigned> &images) const
+{
+  auto it(_orbit.find(origin));
+
+  it->second.apply_inverse(images);
+}
+
 void ExplicitTransversals::dump(std::ostream &os) const
 {
   os << "explicit transversals:\n";
 
   for (auto const &tr : _orbit)
-    os << tr.first << ": " << tr.second << "\n";
+    os << tr.first << ": " << tr.second.perm() << "\n";
 }
 
 } // namespace internal
@@ -0,0 +1,407 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "hash.hpp"
+#include "mapped_task_mappings.hpp"
+#include "packed_task_mappings.hpp"
+#include "task_mapping.hpp"
+
+namespace
+{
+
+char const MAGIC[8] = {'M', 'P', 'S', 'Y', 'M', 'T', 'M', 'S'};
+
+uint32_t const VERSION = 1u;
+
+// slots start at this offset, the header is padded to it
+std::size_t const SLOTS_OFFSET = 64u;
+
+// insertions only keep a slot busy while copying a single row, a slot that
+// stays busy for longer was left behind by a process that died while inserting
+std::chrono::milliseconds const BUSY_SLOT_TIMEOUT(1000);
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "memory mapped task mappings require lock-free 64 bit atomics");
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t),
+              "memory mapped task mappings require plain 64 bit atomics");
+
+} // anonymous namespace
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+struct MappedTaskMappings::Header
+{
+  char magic[sizeof(MAGIC)];
+  uint32_t version;
+  uint32_t mapping_size;
+  uint32_t task_width;
+  uint32_t reserved;
+  uint64_t capacity;
+  uint64_t num_slots;
+  std::atomic<uint64_t> num_mappings;
+};
+
+MappedTaskMappings::MappedTaskMappings(std::string const &file,
+                                       unsigned mapping_size,
+                                       unsigned max_task,
+                                       std::size_t capacity)
+: _file(file),
+  _data(nullptr),
+  _size(0u)
+{
+  static_assert(sizeof(Header) <= SLOTS_OFFSET,
+                "memory mapped task mappings header too large");
+
+  if (capacity > MAX_CAPACITY)
+    throw std::invalid_argument("task mappings capacity too large");
+
+  if (!open())
+    create(mapping_size, max_task, capacity);
+
+  if (this->mapping_size() != mapping_size ||
+      task_width() < packed_task_width(max_task)) {
+    munmap(_data, _size);
+    throw std::invalid_argument("incompatible task mappings file");
+  }
+}
+
+MappedTaskMappings::~MappedTaskMappings()
+{
+  if (_data)
+    munmap(_data, _size);
+}
+
+unsigned MappedTaskMappings::mapping_size() const
+{ return header()->mapping_size; }
+
+unsigned MappedTaskMappings::task_width() const
+{ return header()->task_width; }
+
+std::size_t MappedTaskMappings::size() const
+{
+  // may temporarily exceed the capacity during failed insertions
+  return std::min(
+    static_cast<std::size_t>(header()->num_mappings.load()), capacity());
+}
+
+std::size_t MappedTaskMappings::capacity() const
+{ return header()->capacity; }
+
+std::pair<bool, unsigned> MappedTaskMappings::insert(
+  TaskMapping const &mapping)
+{
+  static thread_local std::vector<unsigned char> query;
+  query.resize(_row_width);
+
+  uint64_t h;
+  if (!pack(mapping, query.data(), &h))
+    throw std::invalid_argument("task mapping not representable");
+
+  uint32_t fragment = static_cast<uint32_t>(h >> 32);
+
+  auto *ss = slots();
+
+  unsigned index;
+
+  for (std::size_t i = h & _slots_mask;; i = (i + 1u) & _slots_mask) {
+    uint64_t s = ss[i].load(std::memory_order_acquire);
+
+    if (s == 0u) {
+      // checked here so that the slot table can never fill up with dead slots
+      if (header()->num_mappings.load() >= capacity())
+        throw std::length_error("task mappings capacity exhausted");
+
+      if (ss[i].compare_exchange_strong(s,
+                                        slot(fragment, SLOT_BUSY),
+                                        std::memory_order_acq_rel,
+                                        std::memory_order_acquire)) {
+
+        uint64_t n = header()->num_mappings.fetch_add(1u);
+
+        if (n >= capacity()) {
+          ss[i].store(slot(fragment, SLOT_DEAD), std::memory_order_release);
+          throw std::length_error("task mappings capacity exhausted");
+        }
+
+        std::memcpy(row(n), query.data(), _row_width);
+
+        ss[i].store(slot(fragment, static_cast<uint32_t>(n + 1u)),
+                    std::memory_order_release);
+
+        return {true, static_cast<unsigned>(n)};
+      }
+
+      // s now holds the value written by a concurrent insertion
+    }
+
+    if (match(s, i, fragment, query.data(), &index))
+      return {false, index};
+  }
+}
+
+bool MappedTaskMappings::contains(TaskMapping const &mapping) const
+{
+  static thread_local std::vector<unsigned char> query;
+  query.resize(_row_width);
+
+  // mappings which can not be stored can also not be contained
+  uint64_t h;
+  if (!pack(mapping, query.data(), &h))
+    return false;
+
+  uint32_t fragment = static_cast<uint32_t>(h >> 32);
+
+  auto *ss = slots();
+
+  unsigned index;
+
+  for (std::size_t i = h & _slots_mask;; i = (i + 1u) & _slots_mask) {
+    uint64_t s = ss[i].load(std::memory_order_acquire);
+
+    if (s == 0u)
+      return false;
+
+    if (match(s, i, fragment, query.data(), &index))
+      return true;
+  }
+}
+
+void MappedTaskMappings::get(std::size_t i, TaskMapping &mapping) const
+{
+  assert(i < size());
+
+  mapping.resize(mapping_size());
+
+  unpack_task_mapping(row(i), task_width(), mapping);
+}
+
+void MappedTaskMappings::create(unsigned mapping_size,
+                                unsigned max_task,
+                                std::size_t capacity)
+{
+  unsigned task_width = packed_task_width(max_task);
+
+  uint64_t num_slots = 16u;
+  while (num_slots < 2u * static_cast<uint64_t>(capacity))
+    num_slots *= 2u;
+
+  std::size_t size = SLOTS_OFFSET +
+                     num_slots * sizeof(uint64_t) +
+                     capacity * mapping_size * task_width;
+
+  // initialize a uniquely named temporary file and link it into place
+  // afterwards so that other threads and processes never observe partially
+  // initialized files, the file is zero filled which marks all slots as empty
+  std::string file_tmp(_file + ".tmpXXXXXX");
+
+  int fd = mkstemp(&file_tmp[0]);
+  if (fd == -1)
+    throw std::runtime_error("failed to create " + file_tmp);
+
+  // mkstemp creates files only accessible by their owner
+  if (fchmod(fd, 0644) == -1 ||
+      ftruncate(fd, static_cast<off_t>(size)) == -1 ||
+      !map(fd, size)) {
+    close(fd);
+    unlink(file_tmp.c_str());
+    throw std::runtime_error("failed to initialize " + file_tmp);
+  }
+
+  close(fd);
+
+  auto *h = header();
+  std::memcpy(h->magic, MAGIC, sizeof(MAGIC));
+  h->version = VERSION;
+  h->mapping_size = mapping_size;
+  h->task_width = task_width;
+  h->capacity = capacity;
+  h->num_slots = num_slots;
+  h->num_mappings.store(0u);
+
+  _row_width = static_cast<std::size_t>(mapping_size) * task_width;
+  _slots_mask = num_slots - 1u;
+
+  bool linked = link(file_tmp.c_str(), _file.c_str()) == 0;
+  int link_errno = errno;
+
+  unlink(file_tmp.c_str());
+
+  if (linked)
+    return;
+
+  munmap(_data, _size);
+  _data = nullptr;
+
+  // another process created the file first
+  if (link_errno != EEXIST || !open())
+    throw std::runtime_error("failed to create " + _file);
+}
+
+bool MappedTaskMappings::open()
+{
+  int fd = ::open(_file.c_str(), O_RDWR);
+  if (fd == -1) {
+    if (errno == ENOENT)
+      return false;
+
+    throw std::runtime_error("failed to open " + _file);
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) == -1 ||
+      static_cast<std::size_t>(st.st_size) < SLOTS_OFFSET) {
+    close(fd);
+    throw std::runtime_error("invalid task mappings file " + _file);
+  }
+
+  if (!map(fd, static_cast<std::size_t>(st.st_size))) {
+    close(fd);
+    throw std::runtime_error("failed to map " + _file);
+  }
+
+  close(fd);
+
+  auto const *h = header();
+
+  _row_width = static_cast<std::size_t>(h->mapping_size) * h->task_width;
+  _slots_mask = h->num_slots - 1u;
+
+  bool valid = std::memcmp(h->magic, MAGIC, sizeof(MAGIC)) == 0 &&
+               h->version == VERSION &&
+               h->num_slots > 0u &&
+               (h->num_slots & _slots_mask) == 0u &&
+               _size == SLOTS_OFFSET +
+                        h->num_slots * sizeof(uint64_t) +
+                        h->capacity * _row_width;
+
+  if (!valid) {
+    munmap(_data, _size);
+    _data = nullptr;
+
+    throw std::runtime_error("invalid task mappings file " + _file);
+  }
+
+  return true;
+}
+
+bool MappedTaskMappings::map(int fd, std::size_t size)
+{
+  void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+  if (data == MAP_FAILED)
+    return false;
+
+  _data = data;
+  _size = size;
+
+  return true;
+}
+
+bool MappedTaskMappings::pack(TaskMapping const &mapping,
+                              unsigned char *row,
+                              uint64_t *h) const
+{
+  if (mapping.size() != mapping_size())
+    return false;
+
+  if (task_width() < 4u) {
+    unsigned max_task = (1u << (8u * task_width())) - 1u;
+
+    for (unsigned task : mapping) {
+      if (task > max_task)
+        return false;
+    }
+  }
+
+  pack_task_mapping(mapping, task_width(), row);
+
+  *h = util::stable_hash(row, _row_width);
+
+  // the lower and upper halves of the hash are used independently, mix them
+  *h ^= *h >> 33;
+  *h *= 0xff51afd7ed558ccdULL;
+  *h ^= *h >> 33;
+  *h *= 0xc4ceb9fe1a85ec53ULL;
+  *h ^= *h >> 33;
+
+  return true;
+}
+
+bool MappedTaskMappings::match(uint64_t &s,
+                               std::size_t i,
+                               uint32_t fragment,
+                               unsigned char const *row,
+                               unsigned *index) const
+{
+  // a concurrent insertion of a mapping with the same hash fragment might
+  // be inserting the very same mapping, wait for it to finish
+  if (slot_tag(s) == SLOT_BUSY && slot_fragment(s) == fragment) {
+    auto deadline(std::chrono::steady_clock::now() + BUSY_SLOT_TIMEOUT);
+
+    do {
+      if (std::chrono::steady_clock::now() > deadline)
+        throw std::runtime_error("stale busy slot in " + _file);
+
+      std::this_thread::yield();
+      s = slots()[i].load(std::memory_order_acquire);
+    } while (slot_tag(s) == SLOT_BUSY && slot_fragment(s) == fragment);
+  }
+
+  uint32_t tag = slot_tag(s);
+
+  if (tag == 0u || tag == SLOT_BUSY || tag == SLOT_DEAD)
+    return false;
+
+  if (slot_fragment(s) != fragment)
+    return false;
+
+  if (std::memcmp(this->row(tag - 1u), row, _row_width) != 0)
+    return false;
+
+  *index = tag - 1u;
+
+  return true;
+}
+
+MappedTaskMappings::Header *MappedTaskMappings::header() const
+{ return static_cast<Header *>(_data); }
+
+std::atomic<uint64_t> *MappedTaskMappings::slots() const
+{
+  return reinterpret_cast<std::atomic<uint64_t> *>(
+    static_cast<unsigned char *>(_data) + SLOTS_OFFSET);
+}
+
+unsigned char *MappedTaskMappings::row(std::size_t i) const
+{
+  return static_cast<unsigned char *>(_data) +
+         SLOTS_OFFSET +
+         (_slots_mask + 1u) * sizeof(uint64_t) +
+         i * _row_width;
+}
+
+} // namespace internal
+
+} // namespace mpsym
@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "metrics.hpp"
+
+#ifndef NMETRICS
+
+using json = nlohmann::json;
+
+namespace
+{
+
+using namespace mpsym::internal::metrics;
+
+struct Totals
+{
+  Totals()
+  : counters(MAX_COUNTERS, 0u),
+    buckets(MAX_HISTOGRAMS, std::vector<uint64_t>(NUM_BUCKETS, 0u)),
+    sums_ns(MAX_HISTOGRAMS, 0u)
+  {}
+
+  void add(ThreadBlock const &block)
+  {
+    for (unsigned c = 0u; c < MAX_COUNTERS; ++c)
+      counters[c] += block.counters[c].load(std::memory_order_relaxed);
+
+    for (unsigned h = 0u; h < MAX_HISTOGRAMS; ++h) {
+      auto const &histogram(block.histograms[h]);
+
+      for (unsigned b = 0u; b < NUM_BUCKETS; ++b)
+        buckets[h][b] += histogram.buckets[b].load(std::memory_order_relaxed);
+
+      sums_ns[h] += histogram.sum_ns.load(std::memory_order_relaxed);
+    }
+  }
+
+  void subtract(Totals const &other)
+  {
+    for (unsigned c = 0u; c < MAX_COUNTERS; ++c)
+      counters[c] -= other.counters[c];
+
+    for (unsigned h = 0u; h < MAX_HISTOGRAMS; ++h) {
+      for (unsigned b = 0u; b < NUM_BUCKETS; ++b)
+        buckets[h][b] -= other.buckets[h][b];
+
+      sums_ns[h] -= other.sums_ns[h];
+    }
+  }
+
+  std::vector<uint64_t> counters;
+  std::vector<std::vector<uint64_t>> buckets;
+  std::vector<uint64_t> sums_ns;
+};
+
+struct Registry
+{
+  std::mutex mutex;
+
+  std::vector<std::string> counter_names;
+  std::vector<std::string> histogram_names;
+
+  std::vector<ThreadBlock *> blocks;
+
+  // values recorded by threads that have since exited
+  Totals retired;
+
+  // values at the time of the last reset
+  Totals baseline;
+
+  Totals current() const
+  {
+    Totals res(retired);
+
+    for (auto const *block : blocks)
+      res.add(*block);
+
+    return res;
+  }
+
+  Totals totals() const
+  {
+    Totals res(current());
+    res.subtract(baseline);
+
+    return res;
+  }
+};
+
+Registry &registry()
+{
+  // never destroyed since threads might still exit during static destruction
+  static Registry *registry = new Registry;
+
+  return *registry;
+}
+
+unsigned register_name(std::vector<std::string> &names,
+                       char const *name,
+                       unsigned max)
+{
+  std::lock_guard<std::mutex> lock(registry().mutex);
+
+  auto it(std::find(names.begin(), names.end(), name));
+  if (it != names.end())
+    return static_cast<unsigned>(it - names.begin());
+
+  if (names.size() == max)
+    throw std::length_error("too many metrics");
+
+  names.push_back(name);
+
+  return static_cast<unsigned>(names.size() - 1u);
+}
+
+class ThreadBlockOwner
+{
+public:
+  ThreadBlockOwner()
+  : _block(new ThreadBlock())
+  {
+    for (auto &counter : _block->counters)
+      counter = 0u;
+
+    for (auto &histogram : _block->histograms) {
+      for (auto &bucket : histogram.buckets)
+        bucket = 0u;
+
+      histogram.sum_ns = 0u;
+    }
+
+    std::lock_guard<std::mutex> lock(registry().mutex);
+
+    registry().blocks.push_back(_block.get());
+  }
+
+  ~ThreadBlockOwner()
+  {
+    std::lock_guard<std::mutex> lock(registry().mutex);
+
+    auto &blocks(registry().blocks);
+    blocks.erase(std::find(blocks.begin(), blocks.end(), _block.get()));
+
+    registry().retired.add(*_block);
+  }
+
+  ThreadBlock &block()
+  { return *_block; }
+
+private:
+  std::unique_ptr<ThreadBlock> _block;
+};
+
+double seconds(uint64_t ns)
+{ return static_cast<double>(ns) / 1e9; }
+
+} // anonymous namespace
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+namespace metrics
+{
+
+std::atomic<bool> enabled(false);
+
+unsigned register_counter(char const *name)
+{ return register_name(registry().counter_names, name, MAX_COUNTERS); }
+
+unsigned register_histogram(char const *name)
+{ return register_name(registry().histogram_names, name, MAX_HISTOGRAMS); }
+
+ThreadBlock &thread_block_init()
+{
+  static thread_local ThreadBlockOwner owner;
+
+  return owner.block();
+}
+
+std::string to_json()
+{
+  std::lock_guard<std::mutex> lock(registry().mutex);
+
+  auto totals(registry().totals());
+
+  json j_counters = json::object();
+
+  for (unsigned c = 0u; c < registry().counter_names.size(); ++c)
+    j_counters[registry().counter_names[c]] = totals.counters[c];
+
+  json j_histograms = json::object();
+
+  for (unsigned h = 0u; h < registry().histogram_names.size(); ++h) {
+    json j_buckets = json::array();
+
+    uint64_t count = 0u;
+    for (unsigned b = 0u; b < NUM_BUCKETS; ++b) {
+      count += totals.buckets[h][b];
+
+      json j_bucket;
+      j_bucket["le"] = b + 1u < NUM_BUCKETS ? json(seconds(1ULL << b))
+                                            : json("+Inf");
+      j_bucket["count"] = count;
+
+      j_buckets.push_back(j_bucket);
+    }
+
+    json j_histogram;
+    j_histogram["count"] = count;
+    j_histogram["sum"] = seconds(totals.sums_ns[h]);
+    j_histogram["buckets"] = j_buckets;
+
+    j_histograms[registry().histogram_names[h]] = j_histogram;
+  }
+
+  json j;
+  j["counters"] = j_counters;
+  j["latencies"] = j_histograms;
+
+  return j.dump();
+}
+
+std::string to_prometheus()
+{
+  std::lock_guard<std::mutex> lock(registry().mutex);
+
+  auto totals(registry().totals());
+
+  std::stringstream ss;
+
+  for (unsigned c = 0u; c < registry().counter_names.size(); ++c) {
+    auto name("mpsym_" + registry().counter_names[c] + "_total");
+
+    ss << "# TYPE " << name << " counter\n"
+       << name << " " << totals.counters[c] << "\n";
+  }
+
+  for (unsigned h = 0u; h < registry().histogram_names.size(); ++h) {
+    auto name("mpsym_" + registry().histogram_names[h] + "_seconds");
+
+    ss << "# TYPE " << name << " histogram\n";
+
+    uint64_t count = 0u;
+    for (unsigned b = 0u; b < NUM_BUCKETS; ++b) {
+      count += totals.buckets[h][b];
+
+      ss << name << "_bucket{le=\"";
+
+      if (b + 1u < NUM_BUCKETS)
+        ss << seconds(1ULL << b);
+      else
+        ss << "+Inf";
+
+      ss << "\"} " << count << "\n";
+    }
+
+    ss << name << "_sum " << seconds(totals.sums_ns[h]) << "\n"
+       << name << "_count " << count << "\n";
+  }
+
+  return ss.str();
+}
+
+void reset()
+{
+  std::lock_guard<std::mutex> lock(registry().mutex);
+
+  registry().baseline = registry().current();
+}
+
+} // namespace metrics
+
+} // namespace internal
+
+} // namespace mpsym
+
+#endif
@@ -32,16 +32,24 @@ T *_alloc(std::size_t sz)
   return static_cast<T *>(ret);
 }
 
-mpsym::internal::PermSet _gens;
-int _gen_degree;
+// nauty's automorphism callback does not take a user data argument, so the
+// generators are collected in state that is local to the calling thread and
+// only valid for the duration of a single call to sparsenauty
+struct GenState
+{
+  mpsym::internal::PermSet *gens;
+  int gen_degree;
+};
+
+thread_local GenState _gen_state;
 
 void _save_gens(int, int *perm, int *, int, int, int)
 {
-  std::vector<unsigned> tmp(_gen_degree);
-  for (int i = 0; i < _gen_degree; ++i)
+  std::vector<unsigned> tmp(_gen_state.gen_degree);
+  for (int i = 0; i < _gen_state.gen_degree; ++i)
     tmp[i] = perm[i];
 
-  _gens.emplace(tmp);
+  _gen_state.gens->emplace(tmp);
 }
 
 } // anonymous namespace
@@ -71,10 +79,6 @@ NautyGraph::~NautyGraph()
   FREES(_lab);
   FREES(_ptn);
   FREES(_orbits);
-
-  naugraph_freedyn();
-  nautil_freedyn();
-  nauty_freedyn();
 }
 
 std::string NautyGraph::to_gap() const
@@ -184,9 +188,9 @@ PermSet NautyGraph::automorphism_generators()
       sg.e[e_offs++] = target;
   }
 
-  // set nauty options
-  static DEFAULTOPTIONS_SPARSEDIGRAPH(nauty_options_directed);
-  static DEFAULTOPTIONS_SPARSEGRAPH(nauty_options_undirected);
+  // set nauty options, these are modified below and thus not shared
+  DEFAULTOPTIONS_SPARSEDIGRAPH(nauty_options_directed);
+  DEFAULTOPTIONS_SPARSEGRAPH(nauty_options_undirected);
 
   auto &nauty_options = _directed ? nauty_options_directed
                                   : nauty_options_undirected;
@@ -195,17 +199,25 @@ PermSet NautyGraph::automorphism_generators()
   nauty_options.userautomproc = _save_gens;
 
   // call nauty
-  _gens.clear();
-  _gen_degree = _n_reduced;
+  PermSet gens;
+
+  _gen_state.gens = &gens;
+  _gen_state.gen_degree = _n_reduced;
 
   statsblk stats;
   sparsenauty(&sg, _lab, _ptn, _orbits, &nauty_options, &stats, nullptr);
 
-  // free memory
+  _gen_state.gens = nullptr;
+
+  // free memory, nauty is built with thread local storage (see
+  // cmake/GetNauty.cmake) so this only frees this thread's workspaces
   SG_FREE(sg);
   nausparse_freedyn();
+  naugraph_freedyn();
+  nautil_freedyn();
+  nauty_freedyn();
 
-  return _gens;
+  return gens;
 }
 
 } // namespace internal
@@ -1,5 +1,7 @@
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <iterator>
 #include <numeric>
 #include <ostream>
@@ -8,6 +10,7 @@
 
 #include "dump.hpp"
 #include "perm.hpp"
+#include "perm_kernels.hpp"
 #include "util.hpp"
 
 namespace mpsym
@@ -16,32 +19,63 @@ namespace mpsym
 namespace internal
 {
 
-Perm::Perm(unsigned deg)
-: _degree(deg),
-  _perm(deg)
+namespace
 {
-  assert(degree() > 0u);
 
-  std::iota(_perm.begin(), _perm.end(), 0u);
+template<typename T>
+void assign_images(T *images, std::vector<unsigned> const &perm)
+{ std::copy(perm.begin(), perm.end(), images); }
+
+template<typename T>
+void assign_identity(T *images, unsigned degree)
+{ std::iota(images, images + degree, static_cast<T>(0)); }
+
+} // anonymous namespace
+
+Perm::Perm(unsigned deg)
+{
+  assert(deg > 0u);
+
+  allocate(deg);
+
+  switch (_width) {
+    case 1u:
+      assign_identity(mutable_data<uint8_t>(), deg);
+      break;
+    case 2u:
+      assign_identity(mutable_data<uint16_t>(), deg);
+      break;
+    default:
+      assign_identity(mutable_data<uint32_t>(), deg);
+  }
 }
 
 Perm::Perm(std::vector<unsigned> const &perm)
 {
-  _perm = perm;
+  assert(!perm.empty());
 
-  assert(!_perm.empty());
+  allocate(*std::max_element(perm.begin(), perm.end()) + 1u);
 
-  _degree = *std::max_element(_perm.begin(), _perm.end()) + 1u;
-
-  assert(_perm.size() == degree());
+  assert(perm.size() == degree());
 
 #ifndef NDEBUG
-  std::set<unsigned> domain(_perm.begin(), _perm.end());
+  std::set<unsigned> domain(perm.begin(), perm.end());
 
   assert(domain.size() == degree());
   assert(*domain.begin() == 0u);
   assert(*domain.rbegin() == degree() - 1u);
 #endif
+
+  switch (_width) {
+    case 1u:
+      assign_images(mutable_data<uint8_t>(), perm);
+      break;
+    case 2u:
+      assign_images(mutable_data<uint16_t>(), perm);
+      break;
+    default:
+      assign_images(mutable_data<uint32_t>(), perm);
+  }
 }
 
 Perm::Perm(unsigned deg, std::vector<std::vector<unsigned>> const &cycles)
@@ -64,10 +98,10 @@ Perm::Perm(unsigned deg, std::vector<std::vector<unsigned>> const &cycles)
 
     for (auto i = 1u; i < cycle.size(); ++i) {
       assert(cycle[i] < degree());
-      _perm[cycle[i - 1u]] = cycle[i];
+      set(cycle[i - 1u], cycle[i]);
     }
 
-    _perm[cycle.back()] = cycle[0];
+    set(cycle.back(), cycle[0]);
 
   } else {
     for (auto i = cycles.begin(); i != cycles.end(); ++i)
@@ -75,20 +109,78 @@ Perm::Perm(unsigned deg, std::vector<std::vector<unsigned>> const &cycles)
   }
 }
 
-unsigned const& Perm::operator[](unsigned i) const
+Perm::Perm(Perm const &other)
 {
-  assert(i < degree());
-  return _perm[i];
+  allocate(other._degree);
+
+  std::memcpy(storage(), other.storage(), bytes());
 }
 
-Perm Perm::operator~() const
+Perm::Perm(Perm &&other) noexcept
+: _degree(other._degree),
+  _width(other._width),
+  _storage(other._storage)
 {
-  std::vector<unsigned> inverse(degree());
+  other._degree = 1u;
+  other._width = 1u;
+  other._storage.local[0] = 0u;
+}
 
-  for (unsigned i = 0u; i < degree(); ++i)
-    inverse[(*this)[i]] = i;
+Perm::~Perm()
+{ deallocate(); }
+
+Perm &Perm::operator=(Perm const &other)
+{
+  if (this == &other)
+    return *this;
 
-  return Perm(inverse);
+  if (other._degree != _degree) {
+    deallocate();
+    allocate(other._degree);
+  }
+
+  std::memcpy(storage(), other.storage(), bytes());
+
+  return *this;
+}
+
+Perm &Perm::operator=(Perm &&other) noexcept
+{
+  if (this == &other)
+    return *this;
+
+  deallocate();
+
+  _degree = other._degree;
+  _width = other._width;
+  _storage = other._storage;
+
+  other._degree = 1u;
+  other._width = 1u;
+  other._storage.local[0] = 0u;
+
+  return *this;
+}
+
+Perm Perm::operator~() const
+{
+  // default constructed permutations are stored inline so the storage can
+  // simply be reallocated without initializing it
+  Perm res;
+  res.allocate(degree());
+
+  switch (_width) {
+    case 1u:
+      perm_invert(data<uint8_t>(), res.mutable_data<uint8_t>(), degree());
+      break;
+    case 2u:
+      perm_invert(data<uint16_t>(), res.mutable_data<uint16_t>(), degree());
+      break;
+    default:
+      perm_invert(data<uint32_t>(), res.mutable_data<uint32_t>(), degree());
+  }
+
+  return res;
 }
 
 std::ostream &operator<<(std::ostream &os, const Perm &perm)
@@ -107,12 +199,7 @@ bool Perm::operator==(Perm const &rhs) const
 {
   assert(rhs.degree() == degree());
 
-  for (unsigned i = 0u; i < degree(); ++i) {
-    if ((*this)[i] != rhs[i])
-      return false;
-  }
-
-  return true;
+  return std::memcmp(storage(), rhs.storage(), bytes()) == 0;
 }
 
 bool Perm::operator<(Perm const &rhs) const
@@ -122,8 +209,16 @@ Perm& Perm::operator*=(Perm const &rhs)
 {
   assert(rhs.degree() == degree());
 
-  for (unsigned i = 0u; i < rhs.degree(); ++i)
-    _perm[i] = rhs[(*this)[i]];
+  switch (_width) {
+    case 1u:
+      perm_compose(mutable_data<uint8_t>(), rhs.data<uint8_t>(), degree());
+      break;
+    case 2u:
+      perm_compose(mutable_data<uint16_t>(), rhs.data<uint16_t>(), degree());
+      break;
+    default:
+      perm_compose(mutable_data<uint32_t>(), rhs.data<uint32_t>(), degree());
+  }
 
   return *this;
 }
@@ -149,6 +244,16 @@ bool Perm::even() const
   return !odd;
 }
 
+std::vector<unsigned> Perm::vect() const
+{
+  std::vector<unsigned> res(degree());
+
+  for (unsigned i = 0u; i < degree(); ++i)
+    res[i] = (*this)[i];
+
+  return res;
+}
+
 std::vector<std::vector<unsigned>> Perm::cycles() const
 {
   std::vector<std::vector<unsigned>> result;
@@ -230,6 +335,39 @@ Perm Perm::shifted(unsigned shift) const
   return Perm(perm_shifted);
 }
 
+void Perm::allocate(unsigned deg)
+{
+  assert(deg > 0u);
+
+  _degree = deg;
+  _width = width(deg);
+
+  if (!inlined())
+    _storage.heap = new unsigned char[bytes()];
+}
+
+void Perm::deallocate()
+{
+  if (!inlined())
+    delete[] _storage.heap;
+}
+
+void Perm::set(unsigned x, unsigned y)
+{
+  assert(x < degree() && y < degree());
+
+  switch (_width) {
+    case 1u:
+      mutable_data<uint8_t>()[x] = static_cast<uint8_t>(y);
+      break;
+    case 2u:
+      mutable_data<uint16_t>()[x] = static_cast<uint16_t>(y);
+      break;
+    default:
+      mutable_data<uint32_t>()[x] = y;
+  }
+}
+
 } // namespace internal
 
 } // namespace mpsym
@@ -239,6 +377,19 @@ namespace std
 
 std::size_t hash<mpsym::internal::Perm>::operator()(
   mpsym::internal::Perm const &perm) const
-{ return mpsym::util::container_hash(perm._perm.begin() + 1u, perm._perm.end()); }
+{
+  using mpsym::util::container_hash;
+
+  unsigned degree = perm.degree();
+
+  switch (perm.width()) {
+    case 1u:
+      return container_hash(perm.data<uint8_t>() + 1, perm.data<uint8_t>() + degree);
+    case 2u:
+      return container_hash(perm.data<uint16_t>() + 1, perm.data<uint16_t>() + degree);
+    default:
+      return container_hash(perm.data<uint32_t>() + 1, perm.data<uint32_t>() + degree);
+  }
+}
 
 } // namespace std
@@ -170,26 +170,94 @@ PermSet PermGroup::wreath_product_generators(PermGroup const &lhs,
 
 PermGroup PermGroup::wreath_product(PermGroup const &lhs,
                                     PermGroup const &rhs,
-                                    BSGSOptions const *bsgs_options_,
-                                    timeout::flag aborted)
+                                    BSGSOptions const *bsgs_options,
+                                    timeout::flag)
 {
   // degree of wreath product
   unsigned wp_degree = lhs.degree() * rhs.degree();
 
-  // generators of wreath product
-  auto wp_generators(wreath_product_generators(lhs, rhs));
-
-  if (wp_generators.empty())
+  if (lhs.is_trivial() && rhs.is_trivial())
     return PermGroup(wp_degree);
 
-  // order of wreath product
-  auto wp_order(wreath_product_order(lhs, rhs));
+  // the base and strong generating set of the wreath product are assembled
+  // from those of lhs and rhs, no Schreier-Sims is necessary
+  auto lhs_base(lhs.bsgs().base());
+  auto lhs_strong_generators(lhs.bsgs().strong_generators());
 
-  // construct wreath product
-  auto bsgs_options(BSGSOptions::fill_defaults(bsgs_options_));
-  bsgs_options.schreier_sims_random_known_order = wp_order;
+  auto rhs_base(rhs.bsgs().base());
+  auto rhs_strong_generators(rhs.bsgs().strong_generators());
+
+  // base points of lhs within block b
+  auto block_base = [&](unsigned b){
+    BSGS::Base res;
+
+    if (lhs_base.empty()) {
+      res.push_back(b * lhs.degree());
+    } else {
+      for (unsigned x : lhs_base)
+        res.push_back(b * lhs.degree() + x);
+    }
+
+    return res;
+  };
+
+  BSGS::Base wp_base;
+  PermSet wp_strong_generators;
+
+  if (rhs.is_trivial()) {
+    // lhs acts on all blocks simultaneously (see wreath_product_generators)
+    wp_base = block_base(0u);
+
+    for (Perm const &perm : lhs_strong_generators) {
+      Perm gen(wp_degree);
+      for (unsigned b = 0u; b < rhs.degree(); ++b)
+        gen *= perm.shifted(b * lhs.degree()).extended(wp_degree);
+
+      wp_strong_generators.insert(gen);
+    }
+
+  } else {
+    // the blocks containing the base points of rhs come first, the pointwise
+    // stabilizer of their lhs base points only permutes the remaining blocks
+    // according to the stabilizer of rhs, after the last of them only the
+    // (independent) actions of lhs on the remaining blocks are left
+    std::vector<unsigned> blocks(rhs_base);
+    std::vector<bool> is_base_block(rhs.degree(), false);
+
+    for (unsigned b : rhs_base)
+      is_base_block[b] = true;
+
+    if (!lhs.is_trivial()) {
+      for (unsigned b = 0u; b < rhs.degree(); ++b) {
+        if (!is_base_block[b])
+          blocks.push_back(b);
+      }
+    }
+
+    for (unsigned b : blocks) {
+      auto base(block_base(b));
+      wp_base.insert(wp_base.end(), base.begin(), base.end());
+    }
+
+    for (unsigned b = 0u; b < rhs.degree(); ++b) {
+      for (Perm const &perm : lhs_strong_generators)
+        wp_strong_generators.insert(
+          perm.shifted(b * lhs.degree()).extended(wp_degree));
+    }
+
+    for (Perm const &perm : rhs_strong_generators) {
+      std::vector<unsigned> gen(wp_degree);
+
+      for (unsigned x = 0u; x < wp_degree; ++x)
+        gen[x] = perm[x / lhs.degree()] * lhs.degree() + x % lhs.degree();
+
+      wp_strong_generators.insert(Perm(gen));
+    }
+  }
 
-  return PermGroup(BSGS(wp_degree, wp_generators, &bsgs_options, aborted));
+  // construct wreath product
+  return PermGroup(
+    BSGS(wp_degree, wp_base, wp_strong_generators, bsgs_options));
 }
 
 BSGS::order_type PermGroup::wreath_product_order(PermGroup const &lhs,
@@ -238,9 +306,55 @@ bool PermGroup::contains_element(Perm const &perm) const
   return _bsgs.strips_completely(perm);
 }
 
+PermGroup PermGroup::setwise_stabilizer(unsigned x,
+                                        unsigned y,
+                                        BSGSOptions const *bsgs_options) const
+{
+  if (is_trivial())
+    return *this;
+
+  // copies of a BSGS share their transversals, so the base is changed on an
+  // independent BSGS which is rebuilt from the base and strong generators
+  // (base changes expect these to be closed under inversion)
+  auto sgs(_bsgs.strong_generators());
+  sgs.insert_inverses();
+
+  BSGS bsgs(degree(), _bsgs.base(), sgs, bsgs_options);
+
+  std::vector<unsigned> prefix {x};
+  if (y != x)
+    prefix.push_back(y);
+
+  bsgs.base_change(prefix);
+
+  // the remainder of the stabilizer chain describes the pointwise stabilizer
+  auto base(bsgs.base());
+  base.erase(base.begin(), base.begin() + prefix.size());
+
+  auto strong_generators(bsgs.strong_generators(prefix.size()));
+
+  // if x and y can be swapped, the setwise stabilizer is generated by the
+  // pointwise stabilizer and one element swapping them, its stabilizer chain
+  // then starts with x, whose basic orbit is {x, y}
+  if (y != x && bsgs.orbit(0u).contains(y)) {
+    Perm t(bsgs.transversal(0u, y));
+    unsigned z = (~t)[x];
+
+    if (bsgs.orbit(1u).contains(z)) {
+      base.insert(base.begin(), x);
+      strong_generators.insert(bsgs.transversal(1u, z) * t);
+    }
+  }
+
+  if (base.empty())
+    return PermGroup(degree());
+
+  return PermGroup(BSGS(degree(), base, strong_generators, bsgs_options));
+}
+
 Perm PermGroup::random_element() const
 {
-  static auto re(util::random_engine());
+  static thread_local auto re(util::random_engine());
 
   Perm result(degree());
   for (unsigned i = 0u; i < _bsgs.base_size(); ++i) {
@@ -259,9 +373,7 @@ PermGroup::const_iterator::const_iterator(PermGroup const &pg)
     _end(false)
 {
   if (_trivial) {
-    _current = Perm(pg.degree());
-
-    _current_valid = true;
+    _partial_products.emplace_back(pg.degree());
 
   } else {
     for (unsigned i = 0u; i < pg.bsgs().base_size(); ++i) {
@@ -273,8 +385,10 @@ PermGroup::const_iterator::const_iterator(PermGroup const &pg)
       _current_factors.insert(transv[0]);
     }
 
-    _current_valid = false;
+    _partial_products.resize(_state.size(), Perm(pg.degree()));
   }
+
+  _partial_products_stale = _partial_products.size();
 }
 
 bool PermGroup::const_iterator::operator==(PermGroup::const_iterator const &rhs) const
@@ -295,16 +409,23 @@ bool PermGroup::const_iterator::operator==(PermGroup::const_iterator const &rhs)
 
 PermGroup::const_iterator::reference PermGroup::const_iterator::current()
 {
-  if (_current_valid)
-    return _current;
+  if (_trivial)
+    return _partial_products[0];
 
-  _current = _current_factors[0];
-  for (unsigned j = 1u; j < _current_factors.size(); ++j)
-    _current = _current_factors[j] * _current;
+  unsigned top = _partial_products.size() - 1u;
 
-  _current_valid = true;
+  for (unsigned i = _partial_products_stale; i-- > 0u;) {
+    if (i == top) {
+      _partial_products[i] = _current_factors[i];
+    } else {
+      _partial_products[i] = _partial_products[i + 1u];
+      _partial_products[i] *= _current_factors[i];
+    }
+  }
+
+  _partial_products_stale = 0u;
 
-  return _current;
+  return _partial_products[0];
 }
 
 void PermGroup::const_iterator::next()
@@ -321,6 +442,8 @@ void PermGroup::const_iterator::next()
 
     _current_factors[i] = _transversals[i][_state[i]];
 
+    _partial_products_stale = std::max(_partial_products_stale, i + 1u);
+
     if (i == _state.size() - 1u && _state[i] == 0u) {
       _end = true;
       break;
@@ -329,8 +452,6 @@ void PermGroup::const_iterator::next()
     if (_state[i] != 0u)
       break;
   }
-
-  _current_valid = false;
 }
 
 std::ostream &operator<<(std::ostream &os, PermGroup const &pg)
@@ -1,13 +1,17 @@
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
 #include <iterator>
 #include <memory>
+#include <numeric>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "dbg.hpp"
 #include "orbit.hpp"
+#include "parallel.hpp"
 #include "perm.hpp"
 #include "perm_group.hpp"
 #include "perm_set.hpp"
@@ -21,9 +25,11 @@ namespace internal
 
 std::vector<PermGroup> PermGroup::disjoint_decomposition(
   bool complete,
-  bool disjoint_orbit_optimization) const
+  bool disjoint_orbit_optimization,
+  unsigned num_threads) const
 {
-  return complete ? disjoint_decomp_complete(disjoint_orbit_optimization)
+  return complete ? disjoint_decomp_complete(disjoint_orbit_optimization,
+                                             num_threads)
                   : disjoint_decomp_incomplete();
 }
 
@@ -91,110 +97,127 @@ void PermGroup::disjoint_decomp_generate_dependency_classes(
   }
 }
 
-bool PermGroup::disjoint_decomp_restricted_subgroups(
-  OrbitPartition const &orbit_split,
-  PermGroup const &perm_group,
-  std::pair<PermGroup, PermGroup> &restricted_subgroups)
+Perm PermGroup::disjoint_decomp_restricted_generator(
+  Perm const &gen,
+  std::vector<unsigned> const &split,
+  std::vector<std::vector<unsigned>> const &orbit_points) const
 {
-  auto split1(orbit_split[0]);
-  auto split2(orbit_split[1]);
+  std::vector<unsigned> images(degree());
+  std::iota(images.begin(), images.end(), 0u);
 
-  PermSet restricted_generators1;
-  PermSet restricted_generators2;
+  for (unsigned i : split) {
+    for (unsigned x : orbit_points[i])
+      images[x] = gen[x];
+  }
 
-  for (Perm const &gen : perm_group.generators()) {
-    Perm restricted_generator1(gen.restricted(split1.begin(), split1.end()));
-    Perm restricted_generator2(gen.restricted(split2.begin(), split2.end()));
+  return Perm(images);
+}
 
-    if (!perm_group.contains_element(restricted_generator1) ||
-        !perm_group.contains_element(restricted_generator2)) {
+bool PermGroup::disjoint_decomp_splits(
+  std::vector<unsigned> const &split,
+  std::vector<std::vector<unsigned>> const &orbit_points) const
+{
+  // the group is the direct product of its restrictions to a union of orbits
+  // and its complement iff all generators restricted to it are group elements,
+  // this only needs the group's own BSGS, no restricted subgroups are built
+  for (Perm const &gen : generators()) {
+    bool moves_split = false;
+
+    for (unsigned i : split) {
+      for (unsigned x : orbit_points[i]) {
+        if (gen[x] != x) {
+          moves_split = true;
+          break;
+        }
+      }
+    }
 
-      DBG(TRACE) << "Restricted groups are not a disjoint subgroup decomposition";
+    if (!moves_split)
+      continue;
 
+    if (!contains_element(
+          disjoint_decomp_restricted_generator(gen, split, orbit_points))) {
       return false;
     }
-
-    restricted_generators1.insert(restricted_generator1);
-    restricted_generators2.insert(restricted_generator2);
   }
 
-  restricted_subgroups.first = PermGroup(perm_group.degree(),
-                                         restricted_generators1);
-
-  restricted_subgroups.second = PermGroup(perm_group.degree(),
-                                          restricted_generators2);
-
-  DBG(TRACE) << "Found disjoint subgroup decomposition:";
-  DBG(TRACE) << restricted_subgroups.first;
-  DBG(TRACE) << restricted_subgroups.second;
-
   return true;
 }
 
-std::vector<PermGroup> PermGroup::disjoint_decomp_join_results(
-  std::vector<PermGroup> const &res1,
-  std::vector<PermGroup> const &res2)
+std::vector<unsigned> PermGroup::disjoint_decomp_minimal_split(
+  std::vector<unsigned> const &orbits,
+  std::vector<std::vector<unsigned>> const &orbit_points,
+  unsigned num_threads) const
 {
-  auto res(res1);
+  enum : std::size_t { BATCH_SIZE = 1024u, MIN_PARALLEL_BATCH_SIZE = 64u };
 
-  res.insert(res.end(), res2.begin(), res2.end());
+  unsigned m = static_cast<unsigned>(orbits.size());
 
-  return res;
-}
+  // test unions of k orbits in order of increasing k, it suffices to consider
+  // unions of at most half of the orbits since the complement of a valid split
+  // is itself a valid split
+  for (unsigned k = 1u; 2u * k <= m; ++k) {
+    std::vector<unsigned> combination(k);
+    std::iota(combination.begin(), combination.end(), 0u);
 
-std::vector<PermGroup> PermGroup::disjoint_decomp_complete_recursive(
-  OrbitPartition const &orbits,
-  PermGroup const &perm_group)
-{
-  // iterate over all possible partitions of the set of all orbits into two sets
-  assert(orbits.num_partitions() < 8 * sizeof(unsigned long long));
+    bool exhausted = false;
 
-  for (auto part = 1ULL; !(part & (1ULL << (orbits.num_partitions() - 1u))); ++part) {
-    OrbitPartition orbit_split(perm_group.degree());
+    while (!exhausted) {
+      std::vector<std::vector<unsigned>> batch;
 
-    for (unsigned x = 0u; x < perm_group.degree(); ++x) {
-      if (orbits.partition_index(x) == -1)
-        continue;
+      while (!exhausted && batch.size() < BATCH_SIZE) {
+        std::vector<unsigned> split(k);
+        for (unsigned i = 0u; i < k; ++i)
+          split[i] = orbits[combination[i]];
 
-      if ((1ULL << orbits.partition_index(x)) & part)
-        orbit_split.change_partition(x, 1);
-      else
-        orbit_split.change_partition(x, 0);
-    }
+        batch.push_back(split);
 
-    DBG(TRACE) << "Considering orbit split:";
-    DBG(TRACE) << orbit_split;
+        // advance to the lexicographically next combination
+        int i = static_cast<int>(k) - 1;
+        while (i >= 0 && combination[i] == m - k + static_cast<unsigned>(i))
+          --i;
 
-    // try to find restricted subgroup decomposition
-    std::pair<PermGroup, PermGroup> restricted_subgroups;
+        if (i < 0) {
+          exhausted = true;
+        } else {
+          ++combination[i];
+          for (unsigned j = static_cast<unsigned>(i) + 1u; j < k; ++j)
+            combination[j] = combination[j - 1u] + 1u;
+        }
+      }
 
-    if (!disjoint_decomp_restricted_subgroups(
-          orbit_split, perm_group, restricted_subgroups))
-      continue;
+      // the first valid split in the batch is chosen so that the result does
+      // not depend on the number of threads
+      std::atomic<std::size_t> first_valid(batch.size());
 
-    DBG(TRACE) << "Restricted groups are a disjoint subgroup decomposition";
+      util::parallel_for(
+        batch.size(),
+        batch.size() < MIN_PARALLEL_BATCH_SIZE ? 1u : num_threads,
+        [&](std::size_t i){
+          if (i >= first_valid.load())
+            return;
 
-    // recurse for both orbit partition elements and return combined result
-    auto orbits_recurse(orbits.split(orbit_split));
+          if (!disjoint_decomp_splits(batch[i], orbit_points))
+            return;
 
-    DBG(TRACE) << "Recursing with orbit partitions:";
-    DBG(TRACE) << orbits_recurse[0];
-    DBG(TRACE) << orbits_recurse[1];
+          auto current(first_valid.load());
+          while (i < current && !first_valid.compare_exchange_weak(current, i));
+        });
 
-    return disjoint_decomp_join_results(
-      disjoint_decomp_complete_recursive(orbits_recurse[0],
-                                         restricted_subgroups.first),
-      disjoint_decomp_complete_recursive(orbits_recurse[1],
-                                         restricted_subgroups.second));
-  }
+      if (first_valid < batch.size()) {
+        DBG(TRACE) << "Found orbit split: " << batch[first_valid];
 
-  DBG(TRACE) << "No further decomposition possible, returning group";
+        return batch[first_valid];
+      }
+    }
+  }
 
-  return {perm_group};
+  return orbits;
 }
 
 std::vector<PermGroup> PermGroup::disjoint_decomp_complete(
-  bool disjoint_orbit_optimization) const
+  bool disjoint_orbit_optimization,
+  unsigned num_threads) const
 {
   DBG(DEBUG) << "Finding (complete) disjoint subgroup decomposition for:";
   DBG(DEBUG) << *this;
@@ -212,7 +235,53 @@ std::vector<PermGroup> PermGroup::disjoint_decomp_complete(
     DBG(TRACE) << orbits;
   }
 
-  auto decomp(disjoint_decomp_complete_recursive(orbits, *this));
+  std::vector<std::vector<unsigned>> orbit_points;
+  for (auto const &orbit : orbits)
+    orbit_points.emplace_back(orbit.begin(), orbit.end());
+
+  // the unions of orbits along which the group splits are closed under
+  // intersection and complement, so the complete decomposition corresponds
+  // to the minimal such unions, these are split off one after another (fixed
+  // points are irrelevant here)
+  std::vector<unsigned> remaining;
+  for (unsigned i = 0u; i < orbit_points.size(); ++i) {
+    if (orbit_points[i].size() > 1u)
+      remaining.push_back(i);
+  }
+
+  unsigned num_remaining = static_cast<unsigned>(remaining.size());
+
+  std::vector<PermGroup> decomp;
+
+  while (!remaining.empty()) {
+    auto split(disjoint_decomp_minimal_split(remaining,
+                                             orbit_points,
+                                             num_threads));
+
+    if (split.size() == num_remaining)
+      break;
+
+    PermSet restricted_generators;
+    for (Perm const &gen : generators()) {
+      auto restricted_generator(
+        disjoint_decomp_restricted_generator(gen, split, orbit_points));
+
+      if (!restricted_generator.id())
+        restricted_generators.insert(restricted_generator);
+    }
+
+    decomp.emplace_back(degree(), restricted_generators);
+
+    std::vector<unsigned> remaining_next;
+    std::set_difference(remaining.begin(), remaining.end(),
+                        split.begin(), split.end(),
+                        std::back_inserter(remaining_next));
+
+    remaining = remaining_next;
+  }
+
+  if (decomp.empty())
+    decomp.push_back(*this);
 
   DBG(DEBUG) << "Found disjoint subgroup decomposition:";
   for (PermGroup const &pg : decomp)
@@ -0,0 +1,414 @@
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include "perm_kernels.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PERM_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+#ifdef PERM_KERNELS_X86
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx2,avx512f,avx512bw")))
+#define TARGET_AVX512VBMI \
+  __attribute__((target("avx2,avx512f,avx512bw,avx512vbmi")))
+#endif
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+namespace
+{
+
+struct CpuFeatures
+{
+  bool avx2 = false;
+  bool avx512 = false;
+  bool avx512vbmi = false;
+};
+
+CpuFeatures const &cpu_features()
+{
+  static CpuFeatures const features = []{
+    CpuFeatures res;
+
+#ifdef PERM_KERNELS_X86
+    __builtin_cpu_init();
+
+    res.avx2 = __builtin_cpu_supports("avx2");
+
+    res.avx512 = res.avx2 &&
+                 __builtin_cpu_supports("avx512f") &&
+                 __builtin_cpu_supports("avx512bw");
+
+    res.avx512vbmi = res.avx512 && __builtin_cpu_supports("avx512vbmi");
+#endif
+
+    return res;
+  }();
+
+  return features;
+}
+
+template<typename T>
+void compose_scalar(T *lhs, T const *rhs, unsigned first, unsigned last)
+{
+  for (unsigned x = first; x < last; ++x)
+    lhs[x] = rhs[lhs[x]];
+}
+
+template<typename T>
+void invert_scalar(T const *perm, T *inverse, unsigned first, unsigned last)
+{
+  for (unsigned x = first; x < last; ++x)
+    inverse[perm[x]] = static_cast<T>(x);
+}
+
+#ifdef PERM_KERNELS_X86
+
+// the SIMD kernels below return the number of leading elements they have
+// processed, the remaining ones are handled by the scalar kernels
+
+TARGET_AVX2
+unsigned compose_avx2(uint32_t *lhs, uint32_t const *rhs, unsigned degree)
+{
+  auto table = reinterpret_cast<int const *>(rhs);
+
+  unsigned x = 0u;
+  for (; x + 8u <= degree; x += 8u) {
+    auto ptr = reinterpret_cast<__m256i *>(lhs + x);
+
+    __m256i idx = _mm256_loadu_si256(ptr);
+    _mm256_storeu_si256(ptr, _mm256_i32gather_epi32(table, idx, 4));
+  }
+
+  return x;
+}
+
+TARGET_AVX2
+unsigned compose_avx2(uint16_t *lhs, uint16_t const *rhs, unsigned degree)
+{
+  // gathers load 32 bits, lanes which would read beyond the end of rhs are
+  // masked out, those can only be the ones whose index is degree - 1
+  auto table = reinterpret_cast<int const *>(rhs);
+
+  __m256i last = _mm256_set1_epi32(static_cast<int>(degree - 1u));
+  __m256i last_image = _mm256_set1_epi32(rhs[degree - 1u]);
+  __m256i low = _mm256_set1_epi32(0xffff);
+
+  unsigned x = 0u;
+  for (; x + 8u <= degree; x += 8u) {
+    auto ptr = reinterpret_cast<__m128i *>(lhs + x);
+
+    __m256i idx = _mm256_cvtepu16_epi32(_mm_loadu_si128(ptr));
+    __m256i safe = _mm256_cmpgt_epi32(last, idx);
+
+    __m256i res = _mm256_and_si256(
+      _mm256_mask_i32gather_epi32(last_image, table, idx, safe, 2), low);
+
+    res = _mm256_permute4x64_epi64(_mm256_packus_epi32(res, res), 0x08);
+
+    _mm_storeu_si128(ptr, _mm256_castsi256_si128(res));
+  }
+
+  return x;
+}
+
+TARGET_AVX2
+__m256i lookup_avx2(__m256i idx, __m256i const *chunks, unsigned num_chunks)
+{
+  __m256i nibble = _mm256_set1_epi8(0x0f);
+
+  __m256i idx_low = _mm256_and_si256(idx, nibble);
+  __m256i idx_high = _mm256_and_si256(_mm256_srli_epi16(idx, 4), nibble);
+
+  __m256i res = _mm256_setzero_si256();
+
+  for (unsigned c = 0u; c < num_chunks; ++c) {
+    __m256i select = _mm256_cmpeq_epi8(idx_high,
+                                       _mm256_set1_epi8(static_cast<char>(c)));
+
+    res = _mm256_blendv_epi8(
+      res, _mm256_shuffle_epi8(chunks[c], idx_low), select);
+  }
+
+  return res;
+}
+
+TARGET_AVX2
+unsigned compose_avx2(uint8_t *lhs, uint8_t const *rhs, unsigned degree)
+{
+  // rhs is split into 16 element chunks which are looked up via byte shuffles,
+  // this only pays off for small degrees
+  if (degree > 64u)
+    return 0u;
+
+  alignas(16) uint8_t table[64] = {};
+  std::memcpy(table, rhs, degree);
+
+  unsigned num_chunks = (degree + 15u) / 16u;
+
+  __m256i chunks[4];
+  for (unsigned c = 0u; c < num_chunks; ++c) {
+    chunks[c] = _mm256_broadcastsi128_si256(
+      _mm_load_si128(reinterpret_cast<__m128i const *>(table + 16u * c)));
+  }
+
+  unsigned x = 0u;
+  for (; x + 32u <= degree; x += 32u) {
+    auto ptr = reinterpret_cast<__m256i *>(lhs + x);
+
+    __m256i idx = _mm256_loadu_si256(ptr);
+    _mm256_storeu_si256(ptr, lookup_avx2(idx, chunks, num_chunks));
+  }
+
+  if (x < degree) {
+    alignas(32) uint8_t tail[32] = {};
+    std::memcpy(tail, lhs + x, degree - x);
+
+    auto ptr = reinterpret_cast<__m256i *>(tail);
+
+    __m256i idx = _mm256_load_si256(ptr);
+    _mm256_store_si256(ptr, lookup_avx2(idx, chunks, num_chunks));
+
+    std::memcpy(lhs + x, tail, degree - x);
+  }
+
+  return degree;
+}
+
+TARGET_AVX512
+unsigned compose_avx512(uint32_t *lhs, uint32_t const *rhs, unsigned degree)
+{
+  unsigned x = 0u;
+  for (; x + 16u <= degree; x += 16u) {
+    __m512i idx = _mm512_loadu_si512(lhs + x);
+
+    // the masked gather with an explicitly zeroed source is used to avoid
+    // reading an undefined register
+    _mm512_storeu_si512(
+      lhs + x,
+      _mm512_mask_i32gather_epi32(
+        _mm512_setzero_si512(), static_cast<__mmask16>(0xffff), idx, rhs, 4));
+  }
+
+  return x;
+}
+
+TARGET_AVX512
+unsigned compose_avx512(uint16_t *lhs, uint16_t const *rhs, unsigned degree)
+{
+  // same masking scheme as in the AVX2 case (permutations of degree at most
+  // 256 are stored as bytes, so rhs never fits into two registers here)
+  auto all = static_cast<__mmask16>(0xffff);
+
+  __m512i last = _mm512_set1_epi32(static_cast<int>(degree - 1u));
+  __m512i last_image = _mm512_set1_epi32(rhs[degree - 1u]);
+
+  unsigned x = 0u;
+  for (; x + 16u <= degree; x += 16u) {
+    auto ptr = reinterpret_cast<__m256i *>(lhs + x);
+
+    __m512i idx = _mm512_maskz_cvtepu16_epi32(all, _mm256_loadu_si256(ptr));
+    __mmask16 safe = _mm512_cmplt_epu32_mask(idx, last);
+
+    __m512i res = _mm512_mask_i32gather_epi32(last_image, safe, idx, rhs, 2);
+
+    _mm256_storeu_si256(ptr, _mm512_maskz_cvtepi32_epi16(all, res));
+  }
+
+  return x;
+}
+
+TARGET_AVX512VBMI
+unsigned compose_avx512vbmi(uint8_t *lhs, uint8_t const *rhs, unsigned degree)
+{
+  assert(degree <= 128u);
+
+  auto mask = [](unsigned n){
+    return n >= 64u ? ~static_cast<__mmask64>(0u)
+                    : static_cast<__mmask64>((1ull << n) - 1u);
+  };
+
+  unsigned degree_low = degree < 64u ? degree : 64u;
+  unsigned degree_high = degree - degree_low;
+
+  __m512i table_low = _mm512_maskz_loadu_epi8(mask(degree_low), rhs);
+  __m512i table_high = _mm512_maskz_loadu_epi8(mask(degree_high), rhs + 64);
+
+  for (unsigned x = 0u; x < degree; x += 64u) {
+    __mmask64 m = mask(degree - x);
+
+    __m512i idx = _mm512_maskz_loadu_epi8(m, lhs + x);
+    _mm512_mask_storeu_epi8(
+      lhs + x, m, _mm512_permutex2var_epi8(table_low, idx, table_high));
+  }
+
+  return degree;
+}
+
+unsigned compose_avx512(uint8_t *lhs, uint8_t const *rhs, unsigned degree)
+{
+  if (cpu_features().avx512vbmi && degree <= 128u)
+    return compose_avx512vbmi(lhs, rhs, degree);
+
+  return compose_avx2(lhs, rhs, degree);
+}
+
+template<typename T>
+unsigned invert_avx2(T const *, T *, unsigned)
+{ return 0u; }
+
+template<typename T>
+unsigned invert_avx512(T const *, T *, unsigned)
+{ return 0u; }
+
+TARGET_AVX512
+unsigned invert_avx512(uint32_t const *perm, uint32_t *inverse, unsigned degree)
+{
+  __m512i images = _mm512_setr_epi32(
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+  __m512i step = _mm512_set1_epi32(16);
+
+  unsigned x = 0u;
+  for (; x + 16u <= degree; x += 16u) {
+    __m512i idx = _mm512_loadu_si512(perm + x);
+    _mm512_i32scatter_epi32(inverse, idx, images, 4);
+
+    images = _mm512_add_epi32(images, step);
+  }
+
+  return x;
+}
+
+#endif // PERM_KERNELS_X86
+
+} // anonymous namespace
+
+bool perm_kernel_variant_supported(PermKernelVariant variant)
+{
+  switch (variant) {
+    case PermKernelVariant::SCALAR:
+      return true;
+    case PermKernelVariant::AVX2:
+      return cpu_features().avx2;
+    case PermKernelVariant::AVX512:
+      return cpu_features().avx512;
+  }
+
+  throw std::logic_error("unreachable");
+}
+
+PermKernelVariant perm_kernel_variant()
+{
+  static PermKernelVariant const variant = []{
+    if (perm_kernel_variant_supported(PermKernelVariant::AVX512))
+      return PermKernelVariant::AVX512;
+
+    if (perm_kernel_variant_supported(PermKernelVariant::AVX2))
+      return PermKernelVariant::AVX2;
+
+    return PermKernelVariant::SCALAR;
+  }();
+
+  return variant;
+}
+
+char const *perm_kernel_variant_name(PermKernelVariant variant)
+{
+  switch (variant) {
+    case PermKernelVariant::SCALAR:
+      return "scalar";
+    case PermKernelVariant::AVX2:
+      return "avx2";
+    case PermKernelVariant::AVX512:
+      return "avx512";
+  }
+
+  throw std::logic_error("unreachable");
+}
+
+template<typename T>
+void perm_compose(T *lhs,
+                  T const *rhs,
+                  unsigned degree,
+                  PermKernelVariant variant)
+{
+  assert(perm_kernel_variant_supported(variant));
+
+  unsigned done = 0u;
+
+#ifdef PERM_KERNELS_X86
+  // for very small degrees the setup cost of the SIMD kernels dominates
+  if (degree < 32u)
+    variant = PermKernelVariant::SCALAR;
+
+  switch (variant) {
+    case PermKernelVariant::AVX2:
+      done = compose_avx2(lhs, rhs, degree);
+      break;
+    case PermKernelVariant::AVX512:
+      done = compose_avx512(lhs, rhs, degree);
+      break;
+    default:
+      break;
+  }
+#else
+  (void)variant;
+#endif
+
+  compose_scalar(lhs, rhs, done, degree);
+}
+
+template<typename T>
+void perm_invert(T const *perm,
+                 T *inverse,
+                 unsigned degree,
+                 PermKernelVariant variant)
+{
+  assert(perm_kernel_variant_supported(variant));
+
+  unsigned done = 0u;
+
+#ifdef PERM_KERNELS_X86
+  switch (variant) {
+    case PermKernelVariant::AVX2:
+      done = invert_avx2(perm, inverse, degree);
+      break;
+    case PermKernelVariant::AVX512:
+      done = invert_avx512(perm, inverse, degree);
+      break;
+    default:
+      break;
+  }
+#else
+  (void)variant;
+#endif
+
+  invert_scalar(perm, inverse, done, degree);
+}
+
+template void perm_compose<uint8_t>(
+  uint8_t *, uint8_t const *, unsigned, PermKernelVariant);
+template void perm_compose<uint16_t>(
+  uint16_t *, uint16_t const *, unsigned, PermKernelVariant);
+template void perm_compose<uint32_t>(
+  uint32_t *, uint32_t const *, unsigned, PermKernelVariant);
+
+template void perm_invert<uint8_t>(
+  uint8_t const *, uint8_t *, unsigned, PermKernelVariant);
+template void perm_invert<uint16_t>(
+  uint16_t const *, uint16_t *, unsigned, PermKernelVariant);
+template void perm_invert<uint32_t>(
+  uint32_t const *, uint32_t *, unsigned, PermKernelVariant);
+
+} // namespace internal
+
+} // namespace mpsym
@@ -0,0 +1,133 @@
+#include <cassert>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include "perm.hpp"
+#include "perm_word.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+PermWord::PermWord(unsigned degree)
+: _degree(degree)
+{ assert(degree > 0u); }
+
+PermWord::PermWord(Perm const &perm)
+: _degree(perm.degree())
+{
+  if (!perm.id())
+    _factors.emplace_back(std::make_shared<Factor const>(perm), false);
+}
+
+unsigned PermWord::operator[](unsigned x) const
+{
+  assert(x < degree());
+
+  for (auto const &factor : _factors)
+    x = factor_images(factor)[x];
+
+  return x;
+}
+
+PermWord PermWord::operator~() const
+{
+  PermWord res(_degree);
+
+  res._factors.reserve(_factors.size());
+
+  for (auto it = _factors.rbegin(); it != _factors.rend(); ++it)
+    res._factors.emplace_back(it->first, !it->second);
+
+  return res;
+}
+
+PermWord &PermWord::operator*=(PermWord const &rhs)
+{
+  assert(rhs.degree() == degree());
+
+  _factors.insert(_factors.end(), rhs._factors.begin(), rhs._factors.end());
+
+  return *this;
+}
+
+bool PermWord::id() const
+{
+  if (_factors.empty())
+    return true;
+
+  auto const &res(images());
+
+  for (unsigned x = 0u; x < _degree; ++x) {
+    if (res[x] != x)
+      return false;
+  }
+
+  return true;
+}
+
+Perm PermWord::perm() const
+{
+  if (_factors.empty())
+    return Perm(_degree);
+
+  return Perm(images());
+}
+
+void PermWord::apply(std::vector<unsigned> &images) const
+{
+  assert(images.size() == _degree);
+
+  for (auto const &factor : _factors) {
+    unsigned const *f = factor_images(factor);
+
+    for (unsigned x = 0u; x < _degree; ++x)
+      images[x] = f[images[x]];
+  }
+}
+
+void PermWord::apply_inverse(std::vector<unsigned> &images) const
+{
+  assert(images.size() == _degree);
+
+  for (auto it = _factors.rbegin(); it != _factors.rend(); ++it) {
+    unsigned const *f = it->second ? it->first->images()
+                                   : it->first->inverse_images();
+
+    for (unsigned x = 0u; x < _degree; ++x)
+      images[x] = f[images[x]];
+  }
+}
+
+std::vector<unsigned> const &PermWord::images() const
+{
+  // multiplied out factor by factor since that accesses memory sequentially
+  static thread_local std::vector<unsigned> res;
+
+  assert(!_factors.empty());
+
+  unsigned const *first = factor_images(_factors[0]);
+  res.assign(first, first + _degree);
+
+  for (unsigned i = 1u; i < _factors.size(); ++i) {
+    unsigned const *factor = factor_images(_factors[i]);
+
+    for (unsigned x = 0u; x < _degree; ++x)
+      res[x] = factor[res[x]];
+  }
+
+  return res;
+}
+
+std::ostream &operator<<(std::ostream &os, PermWord const &pw)
+{
+  os << pw.perm();
+  return os;
+}
+
+} // namespace internal
+
+} // namespace mpsym
@@ -23,7 +23,8 @@ namespace internal
 PrRandomizer::PrRandomizer(PermSet const &generators,
                            unsigned n_generators,
                            unsigned iterations)
-: _gens_orig(generators)
+: _gens_orig(generators),
+  _re(util::random_engine())
 {
   generators.assert_not_empty();
 
@@ -50,22 +51,20 @@ PrRandomizer::PrRandomizer(PermSet const &generators,
 
 Perm PrRandomizer::next()
 {
-  static auto re(util::random_engine());
-
   std::uniform_int_distribution<> randbool(0, 1);
   std::uniform_int_distribution<> rands(1, _gens.size() - 1);
   std::uniform_int_distribution<> randt(1, _gens.size() - 1);
 
   int s, t;
 
-  s  = rands(re);
-  do { t = randt(re); } while (t == s);
+  s  = rands(_re);
+  do { t = randt(_re); } while (t == s);
 
-  if (randbool(re)) {
-    _gens[s] *= (randbool(re) ? _gens[t] : ~_gens[t]);
+  if (randbool(_re)) {
+    _gens[s] *= (randbool(_re) ? _gens[t] : ~_gens[t]);
     _gens[0] *= _gens[s];
   } else {
-    _gens[s] = (randbool(re) ? _gens[t] : ~_gens[t]) * _gens[s];
+    _gens[s] = (randbool(_re) ? _gens[t] : ~_gens[t]) * _gens[s];
     _gens[0] = _gens[s] * _gens[0];
   }
 
@@ -86,14 +85,16 @@ bool PrRandomizer::test_altsym(double epsilon)
 
   assert(_gens_orig.degree() >= 8u);
 
-  // build prime number lookup table
-  static std::unordered_set<unsigned> prime_lookup;
+  // build prime number lookup table (once, this may run concurrently)
+  static std::unordered_set<unsigned> const prime_lookup = []{
+    std::unordered_set<unsigned> res;
 
-  if (prime_lookup.empty()) {
     //for (auto i = 0u; i <= boost::math::max_prime; ++i)
     for (auto i = 0u; i <= 1000u; ++i)
-      prime_lookup.insert(boost::math::prime(i));
-  }
+      res.insert(boost::math::prime(i));
+
+    return res;
+  }();
 
   // check whether group is even transitive
   auto orbit(Orbit::generate(1, _gens_orig.with_inverses()));
@@ -1,13 +1,17 @@
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <ostream>
 #include <utility>
 #include <vector>
 
 #include "perm.hpp"
 #include "perm_set.hpp"
+#include "perm_word.hpp"
 #include "schreier_tree.hpp"
 
 namespace mpsym
@@ -16,6 +20,64 @@ namespace mpsym
 namespace internal
 {
 
+std::size_t SchreierTreeCache::size() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  return _size;
+}
+
+bool SchreierTreeCache::find(unsigned tree, unsigned node, Perm *transversal)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  auto it(_index.find(key(tree, node)));
+  if (it == _index.end())
+    return false;
+
+  _entries.splice(_entries.begin(), _entries, it->second);
+
+  *transversal = it->second->second;
+
+  return true;
+}
+
+void SchreierTreeCache::insert(unsigned tree,
+                               unsigned node,
+                               Perm const &transversal)
+{
+  std::size_t size = entry_size(transversal);
+  if (size > _limit)
+    return;
+
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  key_type k = key(tree, node);
+
+  if (_index.find(k) != _index.end())
+    return;
+
+  while (_size + size > _limit) {
+    auto const &lru(_entries.back());
+
+    _size -= entry_size(lru.second);
+    _index.erase(lru.first);
+    _entries.pop_back();
+  }
+
+  _entries.emplace_front(k, transversal);
+  _index[k] = _entries.begin();
+
+  _size += size;
+}
+
+unsigned SchreierTreeCache::next_tree()
+{
+  static std::atomic<unsigned> tree(0u);
+
+  return tree++;
+}
+
 void SchreierTree::create_edge(
   unsigned origin, unsigned destination, unsigned label)
 {
@@ -61,16 +123,102 @@ Perm SchreierTree::transversal(unsigned origin) const
 {
   Perm result(_degree);
 
+  if (_cache && _cache->find(_cache_tree, origin, &result))
+    return result;
+
+  Perm cached;
+
   unsigned current = origin;
   while(current != _root) {
     Perm const &label = _labels[_edge_labels.find(current)->second];
     result = label * result;
     current = _edges.find(current)->second;
+
+    // the remaining path might already have been multiplied out
+    if (_cache && current != _root &&
+        _cache->find(_cache_tree, current, &cached)) {
+      result = cached * result;
+      break;
+    }
+  }
+
+  if (_cache)
+    _cache->insert(_cache_tree, origin, result);
+
+  return result;
+}
+
+PermWord SchreierTree::transversal_word(unsigned origin) const
+{
+  Perm cached;
+
+  if (_cache && _cache->find(_cache_tree, origin, &cached))
+    return PermWord(cached);
+
+  static thread_local std::vector<unsigned> path;
+
+  path.clear();
+
+  PermWord result(_degree);
+
+  unsigned current = origin;
+  while (current != _root) {
+    path.push_back(_edge_labels.find(current)->second);
+    current = _edges.find(current)->second;
+
+    // the remaining path might already have been multiplied out
+    if (_cache && current != _root &&
+        _cache->find(_cache_tree, current, &cached)) {
+      result = PermWord(cached);
+      break;
+    }
+  }
+
+  for (auto it = path.rbegin(); it != path.rend(); ++it)
+    result *= _label_words[*it];
+
+  if (_cache) {
+    cached = result.perm();
+    _cache->insert(_cache_tree, origin, cached);
+
+    return PermWord(cached);
   }
 
   return result;
 }
 
+void SchreierTree::apply_transversal_inverse(
+  unsigned origin, std::vector<unsigned> &images) const
+{
+  if (_cache) {
+    static thread_local std::vector<unsigned> inverse_images;
+
+    Perm transv(transversal(origin));
+
+    inverse_images.resize(_degree);
+    for (unsigned x = 0u; x < _degree; ++x)
+      inverse_images[transv[x]] = x;
+
+    for (unsigned x = 0u; x < _degree; ++x)
+      images[x] = inverse_images[images[x]];
+
+    return;
+  }
+
+  // the inverse transversal is the product of the inverse labels on the path
+  // from origin to the root, in that order
+  unsigned current = origin;
+  while (current != _root) {
+    _label_words[_edge_labels.find(current)->second].apply_inverse(images);
+    current = _edges.find(current)->second;
+  }
+}
+
+Perm SchreierTree::transversal_inverse(unsigned origin) const
+{
+  return ~transversal(origin);
+}
+
 void SchreierTree::dump(std::ostream &os) const
 {
   std::vector<std::vector<std::pair<unsigned, unsigned>>> adj(_degree + 1u);
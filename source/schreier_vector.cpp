@@ -0,0 +1,190 @@
+#include <cassert>
+#include <numeric>
+#include <ostream>
+#include <vector>
+
+#include "perm.hpp"
+#include "perm_set.hpp"
+#include "perm_word.hpp"
+#include "schreier_vector.hpp"
+
+namespace mpsym
+{
+
+namespace internal
+{
+
+SchreierVector::SchreierVector(unsigned degree,
+                               unsigned root,
+                               PermSet const &labels)
+: _degree(degree),
+  _root(root),
+  _num_labels(0u),
+  _vector(degree, NOT_CONTAINED),
+  _nodes{root}
+{
+  assert(root < degree);
+
+  _vector[root] = ROOT;
+
+  for (Perm const &label : labels)
+    add_label(label);
+}
+
+void SchreierVector::add_label(Perm const &label)
+{
+  assert(label.degree() == _degree);
+
+  _label_inverse_images.resize(_label_inverse_images.size() + _degree);
+
+  unsigned *inverse_images = &_label_inverse_images[_num_labels * _degree];
+
+  for (unsigned x = 0u; x < _degree; ++x)
+    inverse_images[label[x]] = x;
+
+  ++_num_labels;
+}
+
+void SchreierVector::create_edge(
+  unsigned origin, unsigned destination, unsigned label)
+{
+  assert(label < _num_labels);
+  assert(_vector[origin] == NOT_CONTAINED);
+  assert(label_inverse(label)[origin] == destination);
+
+  (void)destination;
+
+  _vector[origin] = static_cast<int>(label);
+  _nodes.push_back(origin);
+}
+
+unsigned SchreierVector::root() const
+{ return _root; }
+
+std::vector<unsigned> SchreierVector::nodes() const
+{ return _nodes; }
+
+PermSet SchreierVector::labels() const
+{
+  PermSet res;
+
+  std::vector<unsigned> images(_degree);
+
+  for (unsigned i = 0u; i < _num_labels; ++i) {
+    unsigned const *inverse_images = label_inverse(i);
+
+    for (unsigned x = 0u; x < _degree; ++x)
+      images[inverse_images[x]] = x;
+
+    res.insert(Perm(images));
+  }
+
+  return res;
+}
+
+bool SchreierVector::contains(unsigned node) const
+{ return node < _degree && _vector[node] != NOT_CONTAINED; }
+
+bool SchreierVector::incoming(unsigned node, Perm const &edge) const
+{
+  assert(edge.degree() == _degree);
+
+  int l = _vector[edge[node]];
+  if (l < 0)
+    return false;
+
+  unsigned const *inverse_images = label_inverse(static_cast<unsigned>(l));
+
+  for (unsigned x = 0u; x < _degree; ++x) {
+    if (inverse_images[edge[x]] != x)
+      return false;
+  }
+
+  return true;
+}
+
+Perm SchreierVector::transversal(unsigned origin) const
+{
+  std::vector<unsigned> res(_degree);
+
+  unsigned const *inverse_images = transversal_inverse_images(origin);
+
+  for (unsigned x = 0u; x < _degree; ++x)
+    res[inverse_images[x]] = x;
+
+  return Perm(res);
+}
+
+Perm SchreierVector::transversal_inverse(unsigned origin) const
+{
+  unsigned const *inverse_images = transversal_inverse_images(origin);
+
+  return Perm(std::vector<unsigned>(inverse_images, inverse_images + _degree));
+}
+
+PermWord SchreierVector::transversal_word(unsigned origin) const
+{
+  return ~PermWord(transversal_inverse(origin));
+}
+
+void SchreierVector::apply_transversal_inverse(
+  unsigned origin, std::vector<unsigned> &images) const
+{
+  assert(contains(origin));
+  assert(images.size() == _degree);
+
+  unsigned current = origin;
+  while (current != _root) {
+    unsigned const *inverse_images =
+      label_inverse(static_cast<unsigned>(_vector[current]));
+
+    for (unsigned x = 0u; x < _degree; ++x)
+      images[x] = inverse_images[images[x]];
+
+    current = inverse_images[current];
+  }
+}
+
+unsigned const *SchreierVector::transversal_inverse_images(
+  unsigned origin) const
+{
+  assert(contains(origin));
+
+  // the inverse transversal is the product of the inverse labels on the path
+  // from origin to the root, in that order
+  static thread_local std::vector<unsigned> res;
+
+  res.resize(_degree);
+  std::iota(res.begin(), res.end(), 0u);
+
+  unsigned current = origin;
+  while (current != _root) {
+    unsigned const *inverse_images =
+      label_inverse(static_cast<unsigned>(_vector[current]));
+
+    for (unsigned x = 0u; x < _degree; ++x)
+      res[x] = inverse_images[res[x]];
+
+    current = inverse_images[current];
+  }
+
+  return res.data();
+}
+
+void SchreierVector::dump(std::ostream &os) const
+{
+  os << "schreier vector: [";
+
+  for (unsigned x = 0u; x < _degree; ++x) {
+    os << _vector[x];
+
+    if (x < _degree - 1u)
+      os << ", ";
+  }
+
+  os << "]\n";
+}
+
+} // namespace internal
+
+} // namespace mpsym
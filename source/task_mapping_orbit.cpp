@@ -1,109 +1,562 @@
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <stdexcept>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "hash.hpp"
+#include "mapped_task_mappings.hpp"
+#include "parallel.hpp"
+#include "sparse_perm.hpp"
 #include "task_mapping.hpp"
+#include "packed_task_mappings.hpp"
 #include "task_mapping_orbit.hpp"
 #include "util.hpp"
 
 namespace mpsym
 {
 
+TMO::Hash::Hash(TaskMapping const &root, internal::PermSet const &generators)
+: _perfect(false),
+  _support_size(0u)
+{
+  std::set<unsigned> support_set(root.begin(), root.end());
+
+  if (!generators.empty()) {
+    for (unsigned x : generators.support())
+      support_set.insert(x);
+  }
+
+  if (support_set.empty())
+    return;
+
+  uint64_t n = support_set.size();
+  unsigned k = root.size();
+
+  uint64_t orbit_size_limit = 1;
+  for (unsigned i = 0u; i < k; ++i) {
+    if (orbit_size_limit > std::numeric_limits<hash_type>::max() / n)
+      return;
+
+    orbit_size_limit *= n;
+  }
+
+  _support_map.resize(*support_set.rbegin() + 1u);
+  _support_size = support_set.size();
+
+  unsigned i = 0u;
+  for (unsigned task : support_set)
+    _support_map[task] = i++;
+
+  _perfect = true;
+}
+
+TMO::Hash::hash_type TMO::Hash::perfect_hash(TaskMapping const &mapping) const
+{
+  hash_type h = 0u;
+
+  hash_type factor = 1u;
+  for (unsigned task : mapping) {
+    assert(task < _support_map.size());
+
+    h += _support_map[task] * factor;
+    factor *= _support_size;
+  }
+
+  return h;
+}
+
+TMO::Hash::hash_type TMO::Hash::container_hash_truncated(
+  TaskMapping const &mapping)
+{ return util::container_hash(mapping.begin(), mapping.end()); }
+
+TMO::IterationState::IterationState(TMO const *orbit)
+: _singular(orbit->_generators.empty()),
+  _exhausted(false),
+  _generators(&orbit->_generators),
+  _generators_sparse(&orbit->_generators_sparse),
+  _hash(orbit->_root, orbit->_generators),
+  _current(orbit->_root),
+  _unprocessed(orbit->_root.size(),
+               _singular ? 0u : orbit->_generators.degree() - 1u)
+{
+  if (!_singular)
+    _processed.insert(_hash(orbit->_root));
+}
+
 void TMO::IterationState::advance()
 {
   if (exhausted())
     return;
 
-  auto current_copy(*current);
-  _unprocessed.erase(current);
-
-  if (_singular)
+  if (_singular) {
+    _exhausted = true;
     return;
+  }
+
+  // the index is only built if some generator moves fewer points than there
+  // are tasks, all other generators are applied to every task directly
+  bool indexed = false;
+
+  for (unsigned i = 0u; i < _generators->size(); ++i) {
+    auto const &gen_sparse((*_generators_sparse)[i]);
 
-  _processed.insert(_hash(current_copy));
+    bool modified;
+    _next = _current;
 
-  for (auto const &gen : *_generators) {
-    TaskMapping next(current_copy.permuted(gen));
+    if (_current.permute_sparsely(gen_sparse)) {
+      if (!indexed) {
+        _index.reset(_current, 0u, _generators->degree());
+        indexed = true;
+      }
 
-    if (_processed.find(_hash(next)) == _processed.end())
-      _unprocessed.insert(next);
+      _next.permute(gen_sparse, _index, 0u, &modified);
+    } else {
+      _next.permute((*_generators)[i], 0u, &modified);
+    }
+
+    if (modified && _processed.insert(_hash(_next)))
+      _unprocessed.push_back(_next);
+  }
+
+  if (_unprocessed.empty()) {
+    _exhausted = true;
+    return;
   }
 
-  current = _unprocessed.begin();
+  _unprocessed.back(_current);
+  _unprocessed.pop_back();
 }
 
 bool TMO::IterationState::exhausted() const
-{ return _unprocessed.empty(); }
+{ return _exhausted; }
+
+constexpr std::size_t TMO::MIN_HEADROOM;
 
-void TMO::IterationState::init_hash(TaskMapping const &root)
+void TMO::for_each(std::function<void(TaskMapping const &)> const &func,
+                   unsigned num_threads) const
 {
-  auto support(_generators->support());
+  if (_generators.empty()) {
+    func(_root);
+    return;
+  }
 
-  std::set<unsigned> support_set(support.begin(), support.end());
-  for (unsigned task : root)
-    support_set.insert(task);
+  num_threads = util::num_threads(num_threads);
 
-  unsigned n = support_set.size();
-  unsigned k = root.size();
+  Hash hash(_root, _generators);
 
-  uint64_t orbit_size_limit = 1;
-  for (unsigned i = 0u; i < k; ++i) {
-    orbit_size_limit *= n;
-    if (orbit_size_limit >= std::numeric_limits<hash_type>::max()) {
-      _hash = container_hash_truncated;
-      return;
+  unsigned mapping_size = _root.size();
+  unsigned max_task = _generators.degree() - 1u;
+
+  internal::PackedTaskMappings level(mapping_size, max_task);
+  level.push_back(_root);
+
+  internal::ConcurrentHashValueSet processed;
+  processed.insert(hash(_root));
+
+  internal::PackedTaskMappings next_level(mapping_size, max_task);
+  std::vector<internal::PackedTaskMappings> next_level_blocks;
+
+  while (!level.empty()) {
+    next_level.clear();
+
+    // the visited table is grown adaptively: every round only expands as many
+    // mappings of the current level as can be inserted without the table
+    // growing by more than half of its current number of elements
+    for (std::size_t first = 0u; first < level.size();) {
+      std::size_t headroom =
+        std::max<std::size_t>(processed.size() / 2u, MIN_HEADROOM);
+
+      std::size_t round_size = std::min<std::size_t>(
+        level.size() - first,
+        std::max<std::size_t>(headroom / _generators.size(), 1u));
+
+      processed.reserve(processed.size() + round_size * _generators.size());
+
+      // every block of the round is expanded into its own buffer, the buffers
+      // are concatenated in block order to form the next level
+      std::size_t num_blocks =
+        std::min<std::size_t>(round_size, 8u * num_threads);
+
+      std::size_t block_size = (round_size + num_blocks - 1u) / num_blocks;
+
+      next_level_blocks.assign(
+        num_blocks, internal::PackedTaskMappings(mapping_size, max_task));
+
+      util::parallel_for(
+        num_blocks,
+        num_threads,
+        [&](std::size_t block){
+          auto &next_level_block(next_level_blocks[block]);
+
+          TaskMapping current, next;
+          internal::TaskMappingIndex index;
+
+          std::size_t block_first = first + block * block_size;
+          std::size_t block_last =
+            std::min(block_first + block_size, first + round_size);
+
+          for (std::size_t i = block_first; i < block_last; ++i) {
+            level.get(i, current);
+
+            func(current);
+
+            // see IterationState::advance
+            bool indexed = false;
+
+            for (unsigned j = 0u; j < _generators.size(); ++j) {
+              auto const &gen_sparse(_generators_sparse[j]);
+
+              bool modified;
+              next = current;
+
+              if (current.permute_sparsely(gen_sparse)) {
+                if (!indexed) {
+                  index.reset(current, 0u, _generators.degree());
+                  indexed = true;
+                }
+
+                next.permute(gen_sparse, index, 0u, &modified);
+              } else {
+                next.permute(_generators[j], 0u, &modified);
+              }
+
+              if (modified && processed.insert(hash(next)))
+                next_level_block.push_back(next);
+            }
+          }
+        },
+        1u);
+
+      for (auto const &next_level_block : next_level_blocks)
+        next_level.append(next_level_block);
+
+      first += round_size;
     }
+
+    std::swap(level, next_level);
   }
+}
 
-  unsigned i = 0u;
-  for (unsigned task : support_set)
-    _hash_support_map[task] = i++;
+class TMORs::Shard
+{
+  struct Table
+  {
+    Table(uint64_t capacity)
+    : mask(capacity - 1u),
+      slots(new std::atomic<uint64_t>[capacity])
+    {
+      for (uint64_t i = 0u; i < capacity; ++i)
+        slots[i].store(0u, std::memory_order_relaxed);
+    }
+
+    uint64_t capacity() const
+    { return mask + 1u; }
+
+    uint64_t mask;
+    std::unique_ptr<std::atomic<uint64_t>[]> slots;
+  };
+
+public:
+  // slots pack (equivalence class + 1) into the upper and a hash fragment into
+  // the lower 32 bits, zero marks an empty slot
+  static uint64_t slot(uint32_t fragment, unsigned equivalence_class)
+  { return (static_cast<uint64_t>(equivalence_class) + 1u) << 32 | fragment; }
+
+  static uint32_t slot_fragment(uint64_t slot)
+  { return static_cast<uint32_t>(slot); }
+
+  static unsigned slot_equivalence_class(uint64_t slot)
+  { return static_cast<unsigned>((slot >> 32) - 1u); }
+
+  Shard()
+  {
+    _tables.emplace_back(new Table(16u));
+    _table.store(_tables.back().get());
+  }
+
+  template<typename FUNC>
+  bool find(uint32_t fragment, FUNC &&matches) const
+  {
+    Table const *table = _table.load(std::memory_order_acquire);
+
+    for (uint64_t i = fragment & table->mask;; i = (i + 1u) & table->mask) {
+      uint64_t s = table->slots[i].load(std::memory_order_acquire);
+
+      if (s == 0u)
+        return false;
+
+      if (slot_fragment(s) == fragment && matches(slot_equivalence_class(s)))
+        return true;
+    }
+  }
+
+  // must be called with mutex held
+  void insert(uint64_t s)
+  {
+    Table *table = _tables.back().get();
+
+    if (2u * (_size + 1u) > table->capacity()) {
+      // old tables stay alive since lock-free readers might still access them
+      std::unique_ptr<Table> table_grown(new Table(2u * table->capacity()));
+
+      for (uint64_t i = 0u; i < table->capacity(); ++i) {
+        uint64_t s_old = table->slots[i].load(std::memory_order_relaxed);
+        if (s_old != 0u)
+          insert(table_grown.get(), s_old, std::memory_order_relaxed);
+      }
+
+      table = table_grown.get();
+
+      _tables.push_back(std::move(table_grown));
+      _table.store(table, std::memory_order_release);
+    }
+
+    insert(table, s, std::memory_order_release);
+
+    ++_size;
+  }
+
+  std::mutex mutex;
+
+private:
+  static void insert(Table *table, uint64_t s, std::memory_order order)
+  {
+    uint64_t i = slot_fragment(s) & table->mask;
+    while (table->slots[i].load(std::memory_order_relaxed) != 0u)
+      i = (i + 1u) & table->mask;
 
-  _hash = [&](TaskMapping const &mapping){ return perfect_hash(mapping); };
+    table->slots[i].store(s, order);
+  }
+
+  std::atomic<Table *> _table;
+  std::vector<std::unique_ptr<Table>> _tables;
+  uint64_t _size = 0u;
+};
+
+TMORs::TMORs()
+: _shards(nullptr),
+  _num_orbits(0u)
+{
+  for (auto &chunk : _chunks)
+    chunk.store(nullptr);
 }
 
-TMO::IterationState::hash_type TMO::IterationState::perfect_hash(
-  TaskMapping const &mapping) const
+TMORs TMORs::mapped(std::string const &file,
+                    unsigned mapping_size,
+                    unsigned max_task,
+                    std::size_t capacity)
 {
-  hash_type h = 0u;
+  TMORs orbits;
 
-  hash_type factor = 1u;
-  for (unsigned task : mapping) {
-    auto it(_hash_support_map.find(task));
-    assert(it != _hash_support_map.end());
+  orbits._mapped.reset(new internal::MappedTaskMappings(file,
+                                                        mapping_size,
+                                                        max_task,
+                                                        capacity));
+  return orbits;
+}
+
+TMORs::TMORs(TMORs const &other)
+: TMORs()
+{ insert_all(other.begin(), other.end()); }
 
-    h += it->second * factor;
-    factor *= _hash_support_map.size();
+TMORs::TMORs(TMORs &&other)
+: TMORs()
+{ *this = std::move(other); }
+
+TMORs::~TMORs()
+{ clear(); }
+
+TMORs &TMORs::operator=(TMORs const &rhs)
+{
+  if (this != &rhs) {
+    clear();
+    insert_all(rhs.begin(), rhs.end());
   }
 
-  return h;
+  return *this;
 }
 
-TMO::IterationState::hash_type TMO::IterationState::container_hash_truncated(
-  TaskMapping const &mapping)
-{ return util::container_hash(mapping.begin(), mapping.end()); }
+TMORs &TMORs::operator=(TMORs &&rhs)
+{
+  if (this != &rhs) {
+    clear();
+
+    _shards.store(rhs._shards.exchange(nullptr));
+
+    for (unsigned i = 0u; i < NUM_CHUNKS; ++i)
+      _chunks[i].store(rhs._chunks[i].exchange(nullptr));
+
+    _num_orbits.store(rhs._num_orbits.exchange(0u));
+
+    _mapped = std::move(rhs._mapped);
+  }
+
+  return *this;
+}
 
 std::pair<bool, unsigned> TMORs::insert(TaskMapping const &mapping)
 {
-  bool new_orbit;
+  if (_mapped)
+    return _mapped->insert(mapping);
+
+  auto h(hash(mapping));
+  auto &s(shard_create(h));
+
+  unsigned equivalence_class;
+
+  if (find(s, h, mapping, &equivalence_class))
+    return {false, equivalence_class};
+
+  std::lock_guard<std::mutex> lock(s.mutex);
+
+  if (find(s, h, mapping, &equivalence_class))
+    return {false, equivalence_class};
+
+  equivalence_class = _num_orbits.fetch_add(1u);
+
+  orbit_repr_slot(equivalence_class) = mapping;
+
+  s.insert(Shard::slot(static_cast<uint32_t>(h), equivalence_class));
+
+  return {true, equivalence_class};
+}
+
+bool TMORs::is_repr(TaskMapping const &mapping) const
+{
+  if (_mapped)
+    return _mapped->contains(mapping);
+
+  auto h(hash(mapping));
+
   unsigned equivalence_class;
 
-  auto it = _orbit_reprs.find(mapping);
-  if (it == _orbit_reprs.end()) {
-    new_orbit = true;
-    equivalence_class = num_orbits();
+  Shard const *s = shard(h);
+
+  return s && find(*s, h, mapping, &equivalence_class);
+}
+
+TaskMapping const &TMORs::orbit_repr(unsigned equivalence_class,
+                                     TaskMapping &buf) const
+{
+  if (!_mapped)
+    return orbit_repr_stored(equivalence_class);
+
+  _mapped->get(equivalence_class, buf);
+
+  return buf;
+}
+
+TaskMapping const &TMORs::orbit_repr_stored(unsigned equivalence_class) const
+{
+  assert(equivalence_class < num_orbits());
+
+  uint64_t i = static_cast<uint64_t>(equivalence_class) +
+               (1u << CHUNK_SIZE_LOG2_MIN);
+
+  unsigned i_log2 = util::log2(i);
+
+  TaskMapping const *chunk =
+    _chunks[i_log2 - CHUNK_SIZE_LOG2_MIN].load(std::memory_order_acquire);
+
+  return chunk[i - (static_cast<uint64_t>(1u) << i_log2)];
+}
+
+uint64_t TMORs::hash(TaskMapping const &mapping)
+{
+  uint64_t h = util::container_hash(mapping.begin(), mapping.end());
+
+  // the lower and upper halves of the hash are used independently, mix them
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+
+  return h;
+}
+
+TMORs::Shard const *TMORs::shard(uint64_t h) const
+{
+  Shard const *shards = _shards.load(std::memory_order_acquire);
+
+  return shards ? &shards[(h >> 32) % NUM_SHARDS] : nullptr;
+}
+
+TMORs::Shard &TMORs::shard_create(uint64_t h)
+{
+  Shard *shards = _shards.load(std::memory_order_acquire);
+
+  if (!shards) {
+    auto *shards_new = new Shard[NUM_SHARDS];
+
+    if (_shards.compare_exchange_strong(shards, shards_new))
+      shards = shards_new;
+    else
+      delete[] shards_new;
+  }
+
+  return shards[(h >> 32) % NUM_SHARDS];
+}
+
+bool TMORs::find(Shard const &shard,
+                 uint64_t h,
+                 TaskMapping const &mapping,
+                 unsigned *equivalence_class) const
+{
+  return shard.find(
+    static_cast<uint32_t>(h),
+    [&](unsigned equivalence_class_){
+      if (orbit_repr_stored(equivalence_class_) != mapping)
+        return false;
+
+      *equivalence_class = equivalence_class_;
+      return true;
+    });
+}
+
+TaskMapping &TMORs::orbit_repr_slot(unsigned equivalence_class)
+{
+  uint64_t i = static_cast<uint64_t>(equivalence_class) +
+               (1u << CHUNK_SIZE_LOG2_MIN);
+
+  unsigned i_log2 = util::log2(i);
+
+  auto &chunk(_chunks[i_log2 - CHUNK_SIZE_LOG2_MIN]);
+
+  TaskMapping *chunk_ptr = chunk.load(std::memory_order_acquire);
 
-    _orbit_reprs[mapping] = equivalence_class;
+  if (!chunk_ptr) {
+    auto *chunk_new = new TaskMapping[static_cast<uint64_t>(1u) << i_log2];
 
-  } else {
-    new_orbit = false;
-    equivalence_class = it->second;
+    if (chunk.compare_exchange_strong(chunk_ptr, chunk_new))
+      chunk_ptr = chunk_new;
+    else
+      delete[] chunk_new;
   }
 
-  return {new_orbit, equivalence_class};
+  return chunk_ptr[i - (static_cast<uint64_t>(1u) << i_log2)];
+}
+
+void TMORs::clear()
+{
+  delete[] _shards.exchange(nullptr);
+
+  for (auto &chunk : _chunks)
+    delete[] chunk.exchange(nullptr);
+
+  _num_orbits.store(0u);
+
+  _mapped.reset();
 }
 
 } // namespace mpsym
@@ -1,8 +1,131 @@
 #include "timeout.hpp"
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <map>
 #include <mutex>
+#include <thread>
+#include <utility>
+
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace
+{
+
+using mpsym::internal::timeout::deadline_id;
+using mpsym::internal::timeout::flag;
+
+class DeadlineService
+{
+  using clock = std::chrono::steady_clock;
+  using key = std::pair<clock::time_point, deadline_id>;
+
+public:
+  static DeadlineService &instance()
+  {
+    // never destroyed since the timer thread is never joined, a child process
+    // created by fork inherits neither the timer thread nor necessarily an
+    // unlocked mutex and thus replaces the inherited service by a new one
+    // (leaking the former)
+    static std::atomic<DeadlineService *> service(nullptr);
+
+    pid_t pid = getpid();
+
+    for (;;) {
+      DeadlineService *current = service.load();
+      if (current && current->_pid == pid)
+        return *current;
+
+      auto *created = new DeadlineService(pid);
+
+      if (service.compare_exchange_strong(current, created)) {
+        created->start();
+        return *created;
+      }
+
+      delete created;
+    }
+  }
+
+  deadline_id schedule(flag const &f, clock::time_point deadline)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // ids are unique across services so that cancelling a deadline inherited
+    // from the parent process never cancels one of the child process
+    deadline_id id = _next_id++;
+
+    auto it(_deadlines.emplace(key(deadline, id), f).first);
+
+    _ids.emplace(id, deadline);
+
+    // the timer thread might need to wake up earlier than planned
+    if (it == _deadlines.begin())
+      _cv.notify_one();
+
+    return id;
+  }
+
+  void cancel(deadline_id id)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it(_ids.find(id));
+    if (it == _ids.end())
+      return;
+
+    _deadlines.erase(key(it->second, id));
+    _ids.erase(it);
+  }
+
+private:
+  explicit DeadlineService(pid_t pid)
+  : _pid(pid)
+  {}
+
+  void start()
+  { std::thread(&DeadlineService::run, this).detach(); }
+
+  void run()
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    for (;;) {
+      if (_deadlines.empty()) {
+        _cv.wait(lock);
+        continue;
+      }
+
+      auto next(_deadlines.begin());
+
+      if (clock::now() < next->first.first) {
+        _cv.wait_until(lock, next->first.first);
+        continue;
+      }
+
+      mpsym::internal::timeout::set(next->second);
+
+      _ids.erase(next->first.second);
+      _deadlines.erase(next);
+    }
+  }
+
+  pid_t _pid;
+
+  std::mutex _mutex;
+  std::condition_variable _cv;
+
+  std::map<key, flag> _deadlines;
+  std::map<deadline_id, clock::time_point> _ids;
+
+  static std::atomic<deadline_id> _next_id;
+};
+
+std::atomic<deadline_id> DeadlineService::_next_id(0u);
+
+} // anonymous namespace
 
 namespace mpsym
 {
@@ -17,6 +140,13 @@ std::atomic<int> _timeout_thread_count(0);
 std::condition_variable _timeout_thread_count_cv;
 std::mutex _timeout_thread_count_mtx;
 
+deadline_id schedule_deadline(flag const &f,
+                              std::chrono::steady_clock::time_point deadline)
+{ return DeadlineService::instance().schedule(f, deadline); }
+
+void cancel_deadline(deadline_id id)
+{ DeadlineService::instance().cancel(id); }
+
 } // namespace timeout
 
 } // namespace internal
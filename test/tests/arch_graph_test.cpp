@@ -1,6 +1,8 @@
 #include <algorithm>
 #include <fstream>
 #include <memory>
+#include <random>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -8,6 +10,7 @@
 #include "gmock/gmock.h"
 
 #include "arch_graph.hpp"
+#include "arch_graph_automorphisms.hpp"
 #include "arch_graph_cluster.hpp"
 #include "arch_graph_system.hpp"
 #include "arch_uniform_super_graph.hpp"
@@ -318,6 +321,74 @@ TEST_F(ArchGraphTest, CanObtainAutomorphisms)
     << "Automorphisms of minimal triangular architecture graph correct.";
 }
 
+TEST_F(ArchGraphTest, CanObtainAutomorphismsConcurrently)
+{
+  enum : unsigned { NUM_THREADS = 4u, NUM_REPETITIONS = 10u };
+
+  std::vector<ArchGraph> arch_graphs {
+    ag_nocol(), ag_vcol(), ag_ecol(), ag_tcol(), ag_tri(), ag_grid33()
+  };
+
+  std::vector<PermGroup> expected_automorphisms;
+  for (auto ag : arch_graphs)
+    expected_automorphisms.push_back(ag.automorphisms());
+
+  std::vector<std::vector<PermGroup>> actual_automorphisms(NUM_THREADS);
+
+  std::vector<std::thread> threads;
+  for (unsigned t = 0u; t < NUM_THREADS; ++t) {
+    threads.emplace_back([&, t]{
+      for (unsigned r = 0u; r < NUM_REPETITIONS; ++r) {
+        for (auto ag : arch_graphs)
+          actual_automorphisms[t].push_back(ag.automorphisms());
+      }
+    });
+  }
+
+  for (auto &thread : threads)
+    thread.join();
+
+  for (auto const &thread_automorphisms : actual_automorphisms) {
+    for (auto i = 0u; i < thread_automorphisms.size(); ++i) {
+      EXPECT_EQ(expected_automorphisms[i % arch_graphs.size()],
+                thread_automorphisms[i])
+        << "Automorphisms computed concurrently correct.";
+    }
+  }
+}
+
+TEST_F(ArchGraphTest, CanUpdateAutomorphismsIncrementally)
+{
+  std::mt19937 re(42u);
+
+  for (unsigned r = 0u; r < 10u; ++r) {
+    ArchGraph ag;
+
+    auto p1 = ag.new_processor_type("P1");
+    auto p2 = ag.new_processor_type("P2");
+    auto c1 = ag.new_channel_type("C1");
+    auto c2 = ag.new_channel_type("C2");
+
+    for (unsigned pe = 0u; pe < 6u; ++pe)
+      ag.add_processor(pe % 3u == 0u ? p1 : p2);
+
+    std::uniform_int_distribution<unsigned> d_pe(0u, 5u);
+    std::uniform_int_distribution<unsigned> d_ct(0u, 3u);
+
+    for (unsigned i = 0u; i < 12u; ++i) {
+      ag.automorphisms();
+
+      ag.add_channel(d_pe(re), d_pe(re), d_ct(re) == 0u ? c2 : c1);
+
+      ArchGraph ag_reset(ag);
+      ag_reset.reset_automorphisms();
+
+      EXPECT_EQ(ag_reset.automorphisms(), ag.automorphisms())
+        << "Incrementally updated automorphisms correct.";
+    }
+  }
+}
+
 class ArchGraphReprVariantTest :
   public ArchGraphTestBase<testing::TestWithParam<ReprOptions::Method>>
 {};
@@ -367,12 +438,65 @@ TEST_P(ArchGraphReprVariantTest, CanTestReprEquivalence)
     expect_generates_orbits(arch_graphs[i], expected_orbits[i], GetParam());
 }
 
+TEST_P(ArchGraphReprVariantTest, CanObtainReprsInBatches)
+{
+  std::vector<std::shared_ptr<ArchGraphSystem>> const arch_graphs {
+    std::make_shared<ArchGraph>(ag_nocol()),
+    std::make_shared<ArchGraph>(ag_vcol()),
+    std::make_shared<ArchGraph>(ag_ecol()),
+    std::make_shared<ArchGraph>(ag_tcol())
+  };
+
+  ReprOptions options;
+  options.method = GetParam();
+
+  for (auto const &ag : arch_graphs) {
+    std::vector<TaskMapping> mappings;
+    for (unsigned i = 0u; i < ag->num_processors(); ++i) {
+      for (unsigned j = 0u; j < ag->num_processors(); ++j) {
+        for (unsigned k = 0u; k < ag->num_processors(); ++k)
+          mappings.push_back(TaskMapping({i, j, k}));
+      }
+    }
+
+    std::vector<TaskMapping> expected_reprs;
+    TMORs expected_orbits;
+
+    for (auto const &mapping : mappings) {
+      expected_reprs.push_back(ag->repr(mapping, &options));
+      expected_orbits.insert(expected_reprs.back());
+    }
+
+    ag->reset_repr();
+
+    EXPECT_EQ(expected_reprs, ag->repr_batch(mappings, &options, 4u))
+      << "Batch representatives correct.";
+
+    TMORs orbits;
+    auto reprs(ag->repr_batch(mappings, orbits, &options, 4u));
+
+    ASSERT_EQ(mappings.size(), reprs.size())
+      << "Batch representatives with orbits complete.";
+
+    for (auto i = 0u; i < reprs.size(); ++i) {
+      EXPECT_EQ(expected_reprs[i], std::get<0>(reprs[i]))
+        << "Batch representative with orbits correct.";
+      EXPECT_TRUE(orbits.is_repr(std::get<0>(reprs[i])))
+        << "Batch representative recorded in orbits.";
+    }
+
+    EXPECT_EQ(expected_orbits, orbits)
+      << "Batch orbit representatives correct.";
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(
   ArchGraphReprVariants,
   ArchGraphReprVariantTest,
   testing::Values(ReprOptions::Method::ITERATE,
                   ReprOptions::Method::LOCAL_SEARCH,
-                  ReprOptions::Method::ORBITS));
+                  ReprOptions::Method::ORBITS,
+                  ReprOptions::Method::BACKTRACK));
 
 template<typename T>
 class ArchGraphClusterTestBase : public T
@@ -440,6 +564,36 @@ TEST_F(ArchGraphClusterTest, CanObtainAutormorphisms)
     << "Automorphisms of minimal architecture graph cluster correct.";
 }
 
+TEST_F(ArchGraphClusterTest, CanObtainAutomorphismsConcurrently)
+{
+  ArchGraphCluster cluster;
+
+  for (unsigned i = 0u; i < 4u; ++i) {
+    auto ag(std::make_shared<ArchGraph>());
+
+    auto p = ag->new_processor_type("P");
+    auto c = ag->new_channel_type("C");
+
+    for (unsigned j = 0u; j <= i + 1u; ++j)
+      ag->add_processor(p);
+
+    for (unsigned j = 0u; j <= i; ++j)
+      ag->add_channel(j, j + 1u, c);
+
+    cluster.add_subsystem(ag);
+  }
+
+  auto expected_automorphisms(cluster.automorphisms());
+
+  cluster.reset_automorphisms();
+
+  AutomorphismOptions options;
+  options.automorphisms_cluster_threads = 4u;
+
+  EXPECT_EQ(expected_automorphisms, cluster.automorphisms(&options))
+    << "Automorphisms of subsystems determined concurrently correct.";
+}
+
 class ArchGraphClusterReprVariantTest :
   public ArchGraphClusterTestBase<testing::TestWithParam<ReprOptions::Method>>
 {};
@@ -463,12 +617,36 @@ TEST_P(ArchGraphClusterReprVariantTest, CanTestReprEquivalence)
     expect_generates_orbits(clusters[i], expected_orbits[i], GetParam());
 }
 
+TEST_P(ArchGraphClusterReprVariantTest, CanObtainReprsConcurrently)
+{
+  ReprOptions options;
+  options.method = GetParam();
+
+  ReprOptions options_concurrent(options);
+  options_concurrent.cluster_threads = 4u;
+
+  unsigned num_processors = cluster_minimal->num_processors();
+
+  for (unsigned i = 0u; i < num_processors; ++i) {
+    for (unsigned j = 0u; j < num_processors; ++j) {
+      for (unsigned k = 0u; k < num_processors; ++k) {
+        TaskMapping mapping({i, j, k});
+
+        EXPECT_EQ(cluster_minimal->repr(mapping, &options),
+                  cluster_minimal->repr(mapping, &options_concurrent))
+          << "Representative of subsystems determined concurrently correct.";
+      }
+    }
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(
   ArchGraphClusterReprVariants,
   ArchGraphClusterReprVariantTest,
   testing::Values(ReprOptions::Method::ITERATE,
                   ReprOptions::Method::LOCAL_SEARCH,
-                  ReprOptions::Method::ORBITS));
+                  ReprOptions::Method::ORBITS,
+                  ReprOptions::Method::BACKTRACK));
 
 template<typename T>
 class ArchUniformSuperGraphTestBase : public T
@@ -552,3 +730,119 @@ TEST_F(ArchUniformSuperGraphTest, CanObtainAutormorphisms)
   EXPECT_EQ(expected_automorphisms, super_graph_minimal->automorphisms())
     << "Automorphisms of uniform architecture super_graph correct.";
 }
+
+TEST_F(ArchUniformSuperGraphTest, CanObtainRepr)
+{
+  ArchGraphAutomorphisms ag_total(super_graph_minimal->automorphisms());
+
+  std::mt19937 gen(0u);
+
+  // tasks below the offset or beyond the last processor are left untouched
+  std::uniform_int_distribution<unsigned> task_dist(0u, 14u);
+
+  for (auto method : {ReprOptions::Method::ITERATE,
+                      ReprOptions::Method::ORBITS,
+                      ReprOptions::Method::BACKTRACK}) {
+
+    ReprOptions options;
+    options.method = method;
+    options.offset = 2u;
+
+    ReprOptions options_iterate(options);
+    options_iterate.method = ReprOptions::Method::ITERATE;
+
+    for (unsigned i = 0u; i < 50u; ++i) {
+      TaskMapping mapping;
+      for (unsigned j = 0u; j < 5u; ++j)
+        mapping.push_back(task_dist(gen));
+
+      EXPECT_EQ(ag_total.repr(mapping, &options_iterate),
+                super_graph_minimal->repr(mapping, &options))
+        << "Representative of " << mapping << " correct.";
+    }
+  }
+}
+
+TEST(ArchUniformSuperGraphTrivialTest, CanObtainRepr)
+{
+  auto super_graph(std::make_shared<ArchGraph>());
+
+  auto sp1 = super_graph->new_processor_type("p1");
+  auto sp2 = super_graph->new_processor_type("p2");
+
+  super_graph->add_processor(sp1);
+  super_graph->add_processor(sp2);
+
+  auto proto(std::make_shared<ArchGraph>());
+
+  auto p = proto->new_processor_type("p");
+  auto c = proto->new_channel_type("c");
+
+  auto pe1 = proto->add_processor(p);
+  auto pe2 = proto->add_processor(p);
+
+  proto->add_channel(pe1, pe2, c);
+
+  auto super_graph_trivial(
+    std::make_shared<ArchUniformSuperGraph>(super_graph, proto));
+
+  ASSERT_EQ(PermGroup(4, {Perm(4, {{0, 1}, {2, 3}})}),
+            super_graph_trivial->automorphisms())
+    << "Automorphisms of uniform architecture super_graph correct.";
+
+  ArchGraphAutomorphisms ag_total(super_graph_trivial->automorphisms());
+
+  for (auto method : {ReprOptions::Method::ITERATE,
+                      ReprOptions::Method::ORBITS,
+                      ReprOptions::Method::BACKTRACK}) {
+
+    ReprOptions options;
+    options.method = method;
+
+    ReprOptions options_iterate(options);
+    options_iterate.method = ReprOptions::Method::ITERATE;
+
+    for (unsigned i = 0u; i < 4u; ++i) {
+      for (unsigned j = 0u; j < 4u; ++j) {
+        TaskMapping mapping({i, j});
+
+        EXPECT_EQ(ag_total.repr(mapping, &options_iterate),
+                  super_graph_trivial->repr(mapping, &options))
+          << "Representative of " << mapping << " correct.";
+      }
+    }
+  }
+}
+
+TEST(ArchGraphAutomorphismsTest, BacktrackProducesCorrectReprs)
+{
+  std::vector<PermGroup> groups {
+    PermGroup::wreath_product(PermGroup::symmetric(3), PermGroup::dihedral(4)),
+    PermGroup::wreath_product(PermGroup::cyclic(4), PermGroup::symmetric(3)),
+    PermGroup(10, {Perm(10, {{0, 1, 2, 3, 4}, {5, 6}}), Perm(10, {{7, 8, 9}})})
+  };
+
+  ReprOptions options_iterate;
+  options_iterate.method = ReprOptions::Method::ITERATE;
+
+  ReprOptions options_backtrack;
+  options_backtrack.method = ReprOptions::Method::BACKTRACK;
+
+  std::mt19937 gen(0u);
+
+  for (auto const &group : groups) {
+    auto ag(std::make_shared<ArchGraphAutomorphisms>(group));
+
+    std::uniform_int_distribution<unsigned> task_dist(0u, group.degree() - 1u);
+
+    for (unsigned i = 0u; i < 50u; ++i) {
+      TaskMapping mapping;
+      for (unsigned j = 0u; j < 6u; ++j)
+        mapping.push_back(task_dist(gen));
+
+      EXPECT_EQ(ag->repr(mapping, &options_iterate),
+                ag->repr(mapping, &options_backtrack))
+        << "Backtracking produces correct representative for " << mapping;
+    }
+  }
+}
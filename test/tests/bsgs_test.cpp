@@ -1,9 +1,18 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <memory>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
+#include <unistd.h>
+
 #include "gmock/gmock.h"
 
 #include "bsgs.hpp"
+#include "bsgs_cache.hpp"
 #include "perm.hpp"
 #include "perm_group.hpp"
 #include "perm_set.hpp"
@@ -13,6 +22,8 @@
 using namespace mpsym;
 using namespace mpsym::internal;
 
+using testing::ElementsAreArray;
+
 TEST(DISABLED_BSGSSolveTest, CanSolveBSGS)
 {
   BSGSOptions bsgs_options;
@@ -47,6 +58,126 @@ TEST(DISABLED_BSGSSolveTest, CanSolveBSGS)
       << "Solving BSGS fails for non-solvable group generating set.";
 }
 
+TEST(BSGSSchreierSimsRandomTest, CanConstructBSGSInParallel)
+{
+  PermSet generators(
+    PermGroup::wreath_product(PermGroup::symmetric(3),
+                              PermGroup::dihedral(4)).generators());
+
+  BSGS::order_type expected_order = 6u * 6u * 6u * 6u * 4u;
+
+  BSGSOptions bsgs_options;
+  bsgs_options.construction = BSGSOptions::Construction::SCHREIER_SIMS_RANDOM;
+  bsgs_options.check_sym = false;
+  bsgs_options.schreier_sims_random_threads = 4u;
+
+  bsgs_options.schreier_sims_random_guarantee = false;
+
+  EXPECT_EQ(expected_order, BSGS(generators, &bsgs_options).order())
+    << "Parallel randomized Schreier-Sims produces correct BSGS.";
+
+  bsgs_options.schreier_sims_random_guarantee = true;
+  bsgs_options.schreier_sims_random_known_order = expected_order;
+
+  EXPECT_EQ(expected_order, BSGS(generators, &bsgs_options).order())
+    << "Parallel randomized Schreier-Sims with known order produces correct BSGS.";
+}
+
+TEST(BSGSSerializationTest, CanSerializeBSGS)
+{
+  PermGroup groups[] = {
+    PermGroup(4),
+    PermGroup::dihedral(8),
+    PermGroup::symmetric(12),
+    PermGroup::dihedral(300)
+  };
+
+  for (auto const &group : groups) {
+    auto const &bsgs(group.bsgs());
+
+    auto buf(bsgs.serialize());
+
+    BSGS bsgs_deserialized(BSGS::deserialize(buf.data(), buf.size()));
+
+    EXPECT_EQ(bsgs.base(), bsgs_deserialized.base())
+      << "Deserialized BSGS has same base.";
+
+    auto strong_generators(bsgs.strong_generators());
+
+    EXPECT_THAT(bsgs_deserialized.strong_generators(),
+                ElementsAreArray(strong_generators.begin(),
+                                 strong_generators.end()))
+      << "Deserialized BSGS has same strong generators.";
+
+    EXPECT_EQ(bsgs.is_symmetric(), bsgs_deserialized.is_symmetric())
+      << "Deserialized BSGS retains symmetry flag.";
+
+    EXPECT_EQ(group, PermGroup(bsgs_deserialized))
+      << "Deserialized BSGS describes same group.";
+
+    EXPECT_THROW(BSGS::deserialize(buf.data(), buf.size() - 1u),
+                 std::runtime_error)
+      << "Deserializing truncated BSGS fails.";
+
+    // claim a huge number of strong generators
+    std::string buf_corrupted(buf);
+    std::uint32_t num_strong_generators = UINT32_MAX;
+    std::memcpy(&buf_corrupted[8u + 5u * sizeof(std::uint32_t)],
+                &num_strong_generators,
+                sizeof(num_strong_generators));
+
+    EXPECT_THROW(BSGS::deserialize(buf_corrupted.data(),
+                                   buf_corrupted.size()),
+                 std::runtime_error)
+      << "Deserializing BSGS with inconsistent header fails.";
+  }
+}
+
+TEST(BSGSSerializationTest, CanCacheBSGS)
+{
+  char directory_template[] = "/tmp/mpsym_bsgs_cache_XXXXXX";
+  ASSERT_NE(nullptr, mkdtemp(directory_template));
+
+  BSGSCache cache(directory_template);
+
+  std::string description("dihedral(8)");
+  std::string description_other("dihedral(9)");
+
+  auto key(BSGSCache::key(description));
+  auto key_other(BSGSCache::key(description_other));
+
+  EXPECT_NE(key, key_other)
+    << "Cache keys depend on description.";
+
+  BSGS bsgs;
+  EXPECT_FALSE(cache.load(description, bsgs))
+    << "Loading uncached BSGS fails.";
+
+  PermGroup group(PermGroup::dihedral(8));
+
+  ASSERT_TRUE(cache.store(description, group.bsgs()))
+    << "Can store BSGS in cache.";
+
+  ASSERT_TRUE(cache.load(description, bsgs))
+    << "Can load cached BSGS.";
+
+  EXPECT_EQ(group, PermGroup(bsgs))
+    << "Cached BSGS describes same group.";
+
+  // simulate a hash collision
+  std::string file(std::string(directory_template) + "/" + key + ".bsgs");
+  std::string file_other(
+    std::string(directory_template) + "/" + key_other + ".bsgs");
+
+  ASSERT_EQ(0, std::rename(file.c_str(), file_other.c_str()));
+
+  EXPECT_FALSE(cache.load(description_other, bsgs))
+    << "Loading BSGS cached for different description fails.";
+
+  std::remove(file_other.c_str());
+  rmdir(directory_template);
+}
+
 //TEST(BSGSBaseSwapTest, CanConjugateBSGS)
 //{
 //  PermGroup pg(5, {Perm(5, {{1, 2}, {3, 4}}), Perm(5, {{1, 4, 2}})});
@@ -0,0 +1,125 @@
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "gmock/gmock.h"
+
+#include "metrics.hpp"
+
+#include "test_main.cpp"
+
+using json = nlohmann::json;
+
+using namespace mpsym::internal;
+
+namespace
+{
+
+void record(unsigned n)
+{
+  for (unsigned i = 0u; i < n; ++i) {
+    METRICS_COUNTER_INC("test_events");
+
+    METRICS_LATENCY("test_latency");
+  }
+}
+
+} // anonymous namespace
+
+class MetricsTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    METRICS_ENABLE();
+    METRICS_RESET();
+  }
+
+  void TearDown() override
+  { METRICS_DISABLE(); }
+};
+
+TEST_F(MetricsTest, CanRecordMetricsConcurrently)
+{
+  unsigned const num_threads = 4u;
+  unsigned const num_events = 1000u;
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 0u; i < num_threads; ++i)
+    threads.emplace_back(record, num_events);
+
+  for (auto &thread : threads)
+    thread.join();
+
+  record(num_events);
+
+  auto j(json::parse(metrics::to_json()));
+
+  unsigned const total = (num_threads + 1u) * num_events;
+
+  EXPECT_EQ(total, j["counters"]["test_events"])
+    << "Counters summed up over all threads.";
+
+  auto j_latency(j["latencies"]["test_latency"]);
+
+  EXPECT_EQ(total, j_latency["count"])
+    << "Latencies recorded for all threads.";
+
+  EXPECT_EQ(total, j_latency["buckets"].back()["count"])
+    << "Histogram buckets are cumulative.";
+}
+
+TEST_F(MetricsTest, CanExportPrometheus)
+{
+  record(10u);
+
+  std::stringstream ss(metrics::to_prometheus());
+
+  std::vector<std::string> lines;
+  for (std::string line; std::getline(ss, line);)
+    lines.push_back(line);
+
+  EXPECT_THAT(lines, testing::Contains("# TYPE mpsym_test_events_total counter"))
+    << "Counter type exported.";
+
+  EXPECT_THAT(lines, testing::Contains("mpsym_test_events_total 10"))
+    << "Counter value exported.";
+
+  EXPECT_THAT(lines, testing::Contains("# TYPE mpsym_test_latency_seconds histogram"))
+    << "Histogram type exported.";
+
+  EXPECT_THAT(lines, testing::Contains("mpsym_test_latency_seconds_bucket{le=\"+Inf\"} 10"))
+    << "Histogram buckets exported.";
+
+  EXPECT_THAT(lines, testing::Contains("mpsym_test_latency_seconds_count 10"))
+    << "Histogram count exported.";
+}
+
+TEST_F(MetricsTest, CanResetAndDisableMetrics)
+{
+  record(10u);
+
+  METRICS_RESET();
+
+  record(5u);
+
+  auto j(json::parse(metrics::to_json()));
+
+  EXPECT_EQ(5u, j["counters"]["test_events"])
+    << "Reset discards previously recorded values.";
+
+  METRICS_DISABLE();
+
+  record(5u);
+
+  j = json::parse(metrics::to_json());
+
+  EXPECT_EQ(5u, j["counters"]["test_events"])
+    << "Nothing recorded while disabled.";
+
+  EXPECT_EQ(5u, j["latencies"]["test_latency"]["count"])
+    << "No latencies recorded while disabled.";
+}
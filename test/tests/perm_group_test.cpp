@@ -175,6 +175,43 @@ TEST(PermGroupTest, CanGenerateRandomElement)
   }
 }
 
+TEST(PermGroupTest, CanObtainSetwiseStabilizer)
+{
+  PermGroup d12(6, {Perm(6, {{0, 1, 2, 3, 4, 5}}), Perm(6, {{1, 5}, {2, 4}})});
+
+  std::vector<std::pair<unsigned, unsigned>> const sets {
+    {0, 0}, {0, 1}, {0, 2}, {0, 3}, {2, 5}
+  };
+
+  for (auto const &set : sets) {
+    std::vector<Perm> expected_elements;
+    for (Perm const &perm : d12) {
+      if (std::minmax(perm[set.first], perm[set.second]) ==
+          std::minmax(set.first, set.second)) {
+        expected_elements.push_back(perm);
+      }
+    }
+
+    for (auto transversals : {BSGSOptions::Transversals::EXPLICIT,
+                              BSGSOptions::Transversals::SCHREIER_TREES}) {
+      BSGSOptions bsgs_options;
+      bsgs_options.transversals = transversals;
+
+      auto stabilizer(
+        d12.setwise_stabilizer(set.first, set.second, &bsgs_options));
+
+      std::vector<Perm> actual_elements;
+      for (Perm const &perm : stabilizer)
+        actual_elements.push_back(perm);
+
+      EXPECT_THAT(actual_elements,
+                  UnorderedElementsAreArray(expected_elements))
+        << "Setwise stabilizer of {" << set.first << ", " << set.second
+        << "} correct.";
+    }
+  }
+}
+
 TEST(PermGroupTest, CanIterateTrivialGroup)
 {
   PermGroup id = PermGroup(4, {});
@@ -273,6 +310,71 @@ TEST(PermGroupTest, CanIterateElements)
     << "Iteration produces every element exactly once (explicit iterator).";
 }
 
+TEST(PermGroupTest, CanVisitElements)
+{
+  PermGroup a4(verified_perm_group(A4));
+
+  unsigned leaf_level = a4.bsgs().base_size();
+
+  std::vector<Perm> expected_members;
+  for (Perm const &perm : a4)
+    expected_members.push_back(perm);
+
+  std::vector<Perm> actual_members;
+
+  a4.visit([&](unsigned level, Perm const &partial_product)
+           -> PermGroup::Visit {
+    if (level == leaf_level)
+      actual_members.push_back(partial_product);
+
+    return PermGroup::Visit::CONTINUE;
+  });
+
+  EXPECT_THAT(actual_members, UnorderedElementsAreArray(expected_members))
+    << "Visiting produces every element exactly once.";
+
+  unsigned first_base_point = a4.bsgs().base_point(0);
+
+  actual_members.clear();
+
+  a4.visit([&](unsigned level, Perm const &partial_product)
+           -> PermGroup::Visit {
+    if (level == 1u && partial_product[first_base_point] != first_base_point)
+      return PermGroup::Visit::SKIP_SUBTREE;
+
+    if (level == leaf_level)
+      actual_members.push_back(partial_product);
+
+    return PermGroup::Visit::CONTINUE;
+  });
+
+  std::vector<Perm> expected_stabilizer_members;
+  for (Perm const &perm : expected_members) {
+    if (perm[first_base_point] == first_base_point)
+      expected_stabilizer_members.push_back(perm);
+  }
+
+  EXPECT_THAT(actual_members,
+              UnorderedElementsAreArray(expected_stabilizer_members))
+    << "Skipping subtrees omits all elements with the skipped prefix.";
+
+  actual_members.clear();
+
+  EXPECT_FALSE(a4.visit([&](unsigned level, Perm const &partial_product)
+                        -> PermGroup::Visit {
+    if (level < leaf_level)
+      return PermGroup::Visit::CONTINUE;
+
+    actual_members.push_back(partial_product);
+
+    return actual_members.size() == 3u ? PermGroup::Visit::STOP
+                                        : PermGroup::Visit::CONTINUE;
+  })) << "Visiting can be stopped early.";
+
+  EXPECT_EQ(3u, actual_members.size())
+    << "Visiting stops immediately.";
+}
+
 class PermGroupConstructionMethodTest : public testing::TestWithParam<
   std::tuple<BSGSOptions::Construction, BSGSOptions::Transversals>> {};
 
@@ -368,7 +470,8 @@ INSTANTIATE_TEST_SUITE_P(ConstructionMethods, PermGroupConstructionMethodTest,
     testing::Values(BSGSOptions::Construction::SCHREIER_SIMS,
                     BSGSOptions::Construction::SCHREIER_SIMS_RANDOM),
     testing::Values(BSGSOptions::Transversals::EXPLICIT,
-                    BSGSOptions::Transversals::SCHREIER_TREES)));
+                    BSGSOptions::Transversals::SCHREIER_TREES,
+                    BSGSOptions::Transversals::SCHREIER_VECTOR)));
                     // TODO: SHALLOW_SCHREIER_TREES
 
 TEST(PermGroupCombinationTest, CanConstructDirectProduct)
@@ -550,6 +653,55 @@ TEST(PermGroupCombinationTest, CanConstructWreathProduct)
   }
 }
 
+TEST(PermGroupCombinationTest, CanAssembleProductBSGS)
+{
+  std::vector<PermGroup> groups {
+    PermGroup(4),
+    PermGroup::symmetric(3),
+    PermGroup::cyclic(4),
+    PermGroup::dihedral(8),
+    PermGroup(5, {Perm(5, {{0, 1, 2}}), Perm(5, {{3, 4}})})
+  };
+
+  for (auto const &lhs : groups) {
+    for (auto const &rhs : groups) {
+      auto wp(PermGroup::wreath_product(lhs, rhs));
+
+      PermGroup wp_expected(lhs.degree() * rhs.degree(),
+                            PermGroup::wreath_product_generators(lhs, rhs));
+
+      EXPECT_EQ(PermGroup::wreath_product_order(lhs, rhs), wp.order())
+        << "Wreath product order correct.";
+
+      EXPECT_EQ(wp_expected, wp)
+        << "Wreath product BSGS assembled correctly.";
+    }
+  }
+
+  auto dp(PermGroup::direct_product(groups.begin(), groups.end()));
+
+  unsigned dp_degree = 0u;
+  PermSet dp_generators;
+
+  for (auto const &group : groups)
+    dp_degree += group.degree();
+
+  unsigned d = 0u;
+  for (auto const &group : groups) {
+    for (Perm const &perm : group.generators())
+      dp_generators.insert(perm.shifted(d).extended(dp_degree));
+
+    d += group.degree();
+  }
+
+  EXPECT_EQ(PermGroup::direct_product_order(groups.begin(), groups.end()),
+            dp.order())
+    << "Direct product order correct.";
+
+  EXPECT_EQ(PermGroup(dp_degree, dp_generators), dp)
+    << "Direct product BSGS assembled correctly.";
+}
+
 class DisjointSubgroupProductTest :
   public testing::TestWithParam<std::pair<bool, bool>> {};
 
@@ -644,6 +796,41 @@ INSTANTIATE_TEST_SUITE_P(DisjointSubgroupProductVariants,
                                                std::make_pair(true, false),
                                                std::make_pair(true, true)));
 
+TEST(DisjointSubgroupProductTest, CanFindDisjointSubgroupProductWithManyOrbits)
+{
+  unsigned num_factors = 70u;
+
+  PermSet generators;
+  std::vector<PermGroup> expected_disjoint_subgroups;
+
+  for (unsigned i = 0u; i < num_factors; ++i) {
+    Perm factor_generator(3u * num_factors, {{3u * i, 3u * i + 1u}});
+    generators.insert(factor_generator);
+
+    expected_disjoint_subgroups.emplace_back(3u * num_factors,
+                                             PermSet({factor_generator}));
+  }
+
+  // diagonal action on ten orbits, no decomposition possible
+  std::vector<std::vector<unsigned>> diagonal_cycles;
+  for (unsigned i = 0u; i < 10u; ++i)
+    diagonal_cycles.push_back({3u * i + 2u, 3u * (i + 10u) + 2u});
+
+  Perm diagonal(3u * num_factors, diagonal_cycles);
+  generators.insert(diagonal);
+
+  expected_disjoint_subgroups.emplace_back(3u * num_factors,
+                                           PermSet({diagonal}));
+
+  PermGroup pg(3u * num_factors, generators);
+
+  for (unsigned num_threads : {1u, 4u}) {
+    EXPECT_THAT(pg.disjoint_decomposition(true, false, num_threads),
+                UnorderedElementsAreArray(expected_disjoint_subgroups))
+      << "Disjoint subgroup product decomposition generated correctly.";
+  }
+}
+
 //TEST(DISABLED_WreathProductTest, CanFindWreathProduct)
 //{
 //  PermGroup pg(12,
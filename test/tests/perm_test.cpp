@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
 #include <sstream>
 #include <unordered_set>
 #include <vector>
@@ -5,6 +9,7 @@
 #include "gmock/gmock.h"
 
 #include "perm.hpp"
+#include "perm_kernels.hpp"
 #include "test_utility.hpp"
 
 #include "test_main.cpp"
@@ -196,3 +201,95 @@ TEST(PermTest, CanRestrictPerm)
       << "Restricting permutation yields correct result.";
   }
 }
+
+template<typename T>
+void check_perm_kernels(unsigned degree)
+{
+  std::mt19937 gen(degree);
+
+  auto random_perm = [&]{
+    std::vector<T> perm(degree);
+    std::iota(perm.begin(), perm.end(), 0u);
+    std::shuffle(perm.begin(), perm.end(), gen);
+    return perm;
+  };
+
+  auto lhs(random_perm());
+  auto rhs(random_perm());
+
+  std::vector<T> expected_product(lhs);
+  perm_compose(expected_product.data(), rhs.data(), degree,
+               PermKernelVariant::SCALAR);
+
+  std::vector<T> expected_inverse(degree);
+  perm_invert(lhs.data(), expected_inverse.data(), degree,
+              PermKernelVariant::SCALAR);
+
+  for (auto variant : {PermKernelVariant::AVX2, PermKernelVariant::AVX512}) {
+    if (!perm_kernel_variant_supported(variant))
+      continue;
+
+    std::vector<T> product(lhs);
+    perm_compose(product.data(), rhs.data(), degree, variant);
+
+    EXPECT_EQ(expected_product, product)
+      << "Composition (" << perm_kernel_variant_name(variant)
+      << ", degree " << degree << ") produces correct result.";
+
+    std::vector<T> inverse(degree);
+    perm_invert(lhs.data(), inverse.data(), degree, variant);
+
+    EXPECT_EQ(expected_inverse, inverse)
+      << "Inversion (" << perm_kernel_variant_name(variant)
+      << ", degree " << degree << ") produces correct result.";
+  }
+}
+
+TEST(PermTest, PermKernelsAgreeWithScalarImplementation)
+{
+  for (unsigned degree : {1u, 7u, 16u, 31u, 33u, 64u, 65u, 100u, 128u, 129u,
+                          255u, 256u}) {
+    check_perm_kernels<uint8_t>(degree);
+    check_perm_kernels<uint16_t>(degree);
+    check_perm_kernels<uint32_t>(degree);
+  }
+
+  for (unsigned degree : {1000u, 4096u, 65535u, 65536u}) {
+    if (degree - 1u <= UINT16_MAX)
+      check_perm_kernels<uint16_t>(degree);
+
+    check_perm_kernels<uint32_t>(degree);
+  }
+}
+
+TEST(PermTest, CanStorePermsOfAnyDegree)
+{
+  for (unsigned degree : {1u, 64u, 65u, 256u, 257u, 65536u, 65537u}) {
+    std::vector<unsigned> images(degree);
+    std::iota(images.begin(), images.end(), 0u);
+    std::reverse(images.begin(), images.end());
+
+    Perm perm(images);
+
+    EXPECT_EQ(images, perm.vect())
+      << "Permutation of degree " << degree << " stored correctly.";
+
+    Perm perm_copy(perm);
+    EXPECT_EQ(perm, perm_copy)
+      << "Copying permutation of degree " << degree << " works.";
+
+    Perm perm_moved(std::move(perm_copy));
+    EXPECT_EQ(perm, perm_moved)
+      << "Moving permutation of degree " << degree << " works.";
+
+    perm_copy = perm_moved;
+    EXPECT_EQ(perm, perm_copy)
+      << "Assigning permutation of degree " << degree << " works.";
+
+    EXPECT_TRUE((perm * perm).id())
+      << "Multiplying permutation of degree " << degree << " works.";
+
+    EXPECT_EQ(perm, ~perm)
+      << "Inverting permutation of degree " << degree << " works.";
+  }
+}
@@ -0,0 +1,82 @@
+#include <vector>
+
+#include "gmock/gmock.h"
+
+#include "perm.hpp"
+#include "perm_word.hpp"
+
+#include "test_main.cpp"
+
+using namespace mpsym;
+using namespace mpsym::internal;
+
+TEST(PermWordTest, CanConstructPermWord)
+{
+  PermWord pw_id(5);
+  EXPECT_EQ(Perm(5), pw_id.perm())
+    << "Identity construction produces identity permutation.";
+
+  EXPECT_TRUE(pw_id.id())
+    << "Identity construction produces identity permutation.";
+
+  Perm perm(5, {{0, 2, 3}});
+
+  PermWord pw(perm);
+  EXPECT_EQ(perm, pw.perm())
+    << "Construction from permutation produces correct permutation.";
+
+  EXPECT_FALSE(pw.id())
+    << "Construction from permutation produces correct permutation.";
+}
+
+TEST(PermWordTest, CanMultiplyAndInvertPermWords)
+{
+  std::vector<Perm> perms {
+    Perm(7, {{0, 1, 3}}),
+    Perm(7, {{3, 4}}),
+    Perm(7, {{1, 6}, {2, 5, 4}}),
+    Perm(7, {{0, 6, 5, 4, 3, 2, 1}})
+  };
+
+  Perm perm(7);
+  PermWord pw(7);
+
+  for (auto const &factor : perms) {
+    perm *= factor;
+    pw *= PermWord(factor);
+  }
+
+  EXPECT_EQ(perms.size(), pw.length())
+    << "Multiplication does not multiply out factors.";
+
+  EXPECT_EQ(perm, pw.perm())
+    << "Multiplication produces correct permutation.";
+
+  for (unsigned x = 0u; x < 7u; ++x) {
+    EXPECT_EQ(perm[x], pw[x])
+      << "Point images computed correctly.";
+  }
+
+  EXPECT_EQ(~perm, (~pw).perm())
+    << "Inversion produces correct permutation.";
+
+  EXPECT_TRUE((pw * ~pw).id())
+    << "Product with inverse is identity.";
+
+  EXPECT_EQ(perm, (~~pw).perm())
+    << "Double inversion produces original permutation.";
+
+  Perm lhs(7, {{0, 5}, {2, 3}});
+
+  std::vector<unsigned> images(lhs.vect());
+  pw.apply(images);
+
+  EXPECT_EQ(lhs * perm, Perm(images))
+    << "Application produces correct product.";
+
+  images = lhs.vect();
+  pw.apply_inverse(images);
+
+  EXPECT_EQ(lhs * ~perm, Perm(images))
+    << "Inverse application produces correct product.";
+}
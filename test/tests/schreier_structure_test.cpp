@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cstddef>
 #include <memory>
 #include <vector>
 
@@ -9,6 +10,7 @@
 #include "perm.hpp"
 #include "perm_set.hpp"
 #include "schreier_tree.hpp"
+#include "schreier_vector.hpp"
 
 #include "test_main.cpp"
 
@@ -21,7 +23,8 @@ template <typename T>
 class SchreierStructureTest : public testing::Test {};
 
 using SchreierStructureTypes = ::testing::Types<ExplicitTransversals,
-                                                SchreierTree>;
+                                                SchreierTree,
+                                                SchreierVector>;
 
 TYPED_TEST_SUITE(SchreierStructureTest, SchreierStructureTypes,);
 
@@ -89,6 +92,79 @@ TYPED_TEST(SchreierStructureTest, CanConstructSchreierStructures)
       EXPECT_EQ(origin, transv[root])
         << "Transversal " << transv << " correct "
         << "(root is " << root << ", origin is " << origin << ").";
+
+      EXPECT_EQ(~transv, schreier_structure->transversal_inverse(origin))
+        << "Inverse transversal correct "
+        << "(root is " << root << ", origin is " << origin << ").";
+
+      EXPECT_EQ(transv, schreier_structure->transversal_word(origin).perm())
+        << "Transversal word correct "
+        << "(root is " << root << ", origin is " << origin << ").";
+
+      std::vector<unsigned> images(generators[0].vect());
+      schreier_structure->apply_transversal_inverse(origin, images);
+
+      EXPECT_EQ(generators[0] * ~transv, Perm(images))
+        << "Inverse transversal applied correctly "
+        << "(root is " << root << ", origin is " << origin << ").";
+    }
+  }
+}
+
+TEST(SchreierTreeTest, CanCacheTransversals)
+{
+  unsigned n = 20;
+
+  std::vector<unsigned> cycle(n);
+  for (unsigned i = 0u; i < n; ++i)
+    cycle[i] = i;
+
+  PermSet generators {
+    Perm(n, {cycle}),
+    Perm(n, {{0, 1}})
+  };
+
+  generators.insert_inverses();
+
+  auto schreier_tree(std::make_shared<SchreierTree>(n, 0u, generators));
+  Orbit::generate(0u, generators, schreier_tree);
+
+  for (std::size_t limit : {1u, 300u, 100000u}) {
+    auto cache(std::make_shared<SchreierTreeCache>(limit));
+
+    auto schreier_tree_cached(
+      std::make_shared<SchreierTree>(n, 0u, generators, cache));
+
+    Orbit::generate(0u, generators, schreier_tree_cached);
+
+    for (unsigned i = 0u; i < 2u; ++i) {
+      for (unsigned x = 0u; x < n; ++x) {
+        EXPECT_EQ(schreier_tree->transversal(x),
+                  schreier_tree_cached->transversal(x))
+          << "Cached transversal correct "
+          << "(cache limit is " << limit << ", origin is " << x << ").";
+
+        EXPECT_EQ(schreier_tree->transversal(x),
+                  schreier_tree_cached->transversal_word(x).perm())
+          << "Cached transversal word correct "
+          << "(cache limit is " << limit << ", origin is " << x << ").";
+      }
     }
+
+    EXPECT_LE(cache->size(), limit)
+      << "Cache limit respected.";
   }
+
+  auto cache(std::make_shared<SchreierTreeCache>(100000u));
+
+  auto schreier_tree_cached(
+    std::make_shared<SchreierTree>(n, 0u, generators, cache));
+
+  Orbit::generate(0u, generators, schreier_tree_cached);
+
+  for (unsigned x = 0u; x < n; ++x)
+    schreier_tree_cached->transversal_word(x);
+
+  EXPECT_GT(cache->size(), 0u)
+    << "Transversal words are cached.";
 }
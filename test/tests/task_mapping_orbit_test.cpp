@@ -0,0 +1,376 @@
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include "gmock/gmock.h"
+
+#include "perm.hpp"
+#include "perm_group.hpp"
+#include "perm_set.hpp"
+#include "sparse_perm.hpp"
+#include "task_mapping.hpp"
+#include "task_mapping_orbit.hpp"
+
+#include "test_main.cpp"
+
+using namespace mpsym;
+using namespace mpsym::internal;
+
+namespace
+{
+
+std::vector<TaskMapping> all_mappings(unsigned num_tasks, unsigned num_pes)
+{
+  std::vector<TaskMapping> res;
+
+  TaskMapping mapping(std::vector<unsigned>(num_tasks, 0u));
+
+  for (;;) {
+    res.push_back(mapping);
+
+    unsigned i = 0u;
+    while (i < num_tasks && ++mapping[i] == num_pes)
+      mapping[i++] = 0u;
+
+    if (i == num_tasks)
+      break;
+  }
+
+  return res;
+}
+
+std::set<TaskMapping> orbit(TaskMapping const &mapping,
+                            PermSet const &generators)
+{
+  std::set<TaskMapping> res;
+
+  TMO orbit(mapping, generators);
+  for (auto const &mapping : orbit)
+    res.insert(mapping);
+
+  return res;
+}
+
+std::set<TaskMapping> orbit_expected(TaskMapping const &mapping,
+                                     PermSet const &generators)
+{
+  std::set<TaskMapping> res;
+
+  PermGroup pg(generators.degree(), generators);
+  for (auto const &perm : pg)
+    res.insert(mapping.permuted(perm));
+
+  return res;
+}
+
+} // namespace
+
+TEST(TaskMappingTest, CanPermuteSparsely)
+{
+  unsigned const offset = 2u;
+
+  PermSet perms {
+    Perm(5, {{0, 1, 2, 3}}),
+    Perm(5, {{0, 1}}),
+    Perm(5, {{2, 4}}),
+    Perm(5)
+  };
+
+  for (auto const &mapping : all_mappings(3u, 8u)) {
+    TaskMappingIndex index(mapping, offset, 5u);
+
+    for (auto const &perm : perms) {
+      SparsePerm sparse_perm(perm);
+
+      EXPECT_EQ(mapping.less_than(mapping, perm, offset),
+                mapping.permuted_less_than(sparse_perm, index, offset))
+        << "Sparse comparison of " << mapping << " correct.";
+
+      bool modified, modified_sparse;
+      auto mapping_permuted(mapping.permuted(perm, offset, &modified));
+
+      EXPECT_EQ(mapping_permuted,
+                mapping.permuted(sparse_perm, index, offset, &modified_sparse))
+        << "Sparse permutation of " << mapping << " correct.";
+
+      EXPECT_EQ(modified, modified_sparse)
+        << "Sparse permutation of " << mapping << " detects modification.";
+
+      TaskMappingIndex index_permuted(index);
+      index_permuted.permute(sparse_perm);
+
+      TaskMappingIndex index_expected(mapping_permuted, offset, 5u);
+
+      TaskMappingIndex index_reset(index);
+      index_reset.reset(mapping_permuted, offset, 5u);
+
+      for (unsigned task = 0u; task < 5u; ++task) {
+        EXPECT_EQ(std::vector<unsigned>(index_expected.positions_begin(task),
+                                        index_expected.positions_end(task)),
+                  std::vector<unsigned>(index_permuted.positions_begin(task),
+                                        index_permuted.positions_end(task)))
+          << "Permuted index of " << mapping << " correct.";
+
+        EXPECT_EQ(std::vector<unsigned>(index_expected.positions_begin(task),
+                                        index_expected.positions_end(task)),
+                  std::vector<unsigned>(index_reset.positions_begin(task),
+                                        index_reset.positions_end(task)))
+          << "Reset index of " << mapping << " correct.";
+      }
+    }
+  }
+}
+
+TEST(TMOTest, CanEnumerateOrbit)
+{
+  PermSet generators {
+    Perm(5, {{0, 1, 2, 3}}),
+    Perm(5, {{0, 1}})
+  };
+
+  for (auto const &mapping : all_mappings(3u, 5u)) {
+    EXPECT_EQ(orbit_expected(mapping, generators), orbit(mapping, generators))
+      << "Orbit of " << mapping << " enumerated correctly.";
+  }
+
+  TaskMapping mapping({1, 1, 4});
+
+  EXPECT_EQ(std::set<TaskMapping>{mapping}, orbit(mapping, PermSet()))
+    << "Orbit under trivial group enumerated correctly.";
+}
+
+TEST(TMOTest, CanEnumerateOrbitOfLargeDegree)
+{
+  enum : unsigned { DEGREE = 300u };
+
+  std::vector<unsigned> cycle(DEGREE);
+  for (unsigned i = 0u; i < DEGREE; ++i)
+    cycle[i] = i;
+
+  PermSet generators {Perm(DEGREE, {cycle})};
+
+  TaskMapping mapping({0, 7, 299});
+
+  EXPECT_EQ(orbit_expected(mapping, generators), orbit(mapping, generators))
+    << "Orbit enumerated correctly.";
+}
+
+TEST(TMOTest, CanEnumerateOrbitInParallel)
+{
+  PermSet generators {
+    Perm(8, {{0, 1, 2, 3, 4, 5, 6, 7}}),
+    Perm(8, {{0, 1}})
+  };
+
+  for (unsigned num_threads : {1u, 4u}) {
+    for (auto const &mapping : {TaskMapping({0, 0, 3, 5}),
+                                TaskMapping({1, 2, 3, 4, 5})}) {
+      std::mutex mutex;
+      std::multiset<TaskMapping> res;
+
+      TMO(mapping, generators).for_each(
+        [&](TaskMapping const &mapping){
+          std::lock_guard<std::mutex> lock(mutex);
+          res.insert(mapping);
+        },
+        num_threads);
+
+      auto expected(orbit_expected(mapping, generators));
+
+      EXPECT_EQ(std::multiset<TaskMapping>(expected.begin(), expected.end()),
+                res)
+        << "Orbit of " << mapping << " enumerated correctly using "
+        << num_threads << " thread(s).";
+    }
+  }
+
+  TaskMapping mapping({1, 1, 4});
+
+  std::vector<TaskMapping> res;
+  TMO(mapping, PermSet()).for_each(
+    [&](TaskMapping const &mapping){ res.push_back(mapping); });
+
+  EXPECT_EQ(std::vector<TaskMapping>{mapping}, res)
+    << "Orbit under trivial group enumerated correctly.";
+}
+
+TEST(TMORsTest, CanInsertRepresentatives)
+{
+  TMORs orbits;
+
+  EXPECT_EQ(std::make_pair(true, 0u), orbits.insert(TaskMapping({0, 1})))
+    << "Inserting new representative creates new orbit.";
+
+  EXPECT_EQ(std::make_pair(true, 1u), orbits.insert(TaskMapping({1, 0})))
+    << "Inserting new representative creates new orbit.";
+
+  EXPECT_EQ(std::make_pair(false, 0u), orbits.insert(TaskMapping({0, 1})))
+    << "Reinserting representative yields existing orbit.";
+
+  EXPECT_EQ(2u, orbits.num_orbits())
+    << "Number of orbits correct.";
+
+  EXPECT_TRUE(orbits.is_repr(TaskMapping({1, 0})))
+    << "Inserted mapping is representative.";
+
+  EXPECT_FALSE(orbits.is_repr(TaskMapping({1, 1})))
+    << "Mapping not inserted is not representative.";
+
+  std::vector<TaskMapping> reprs;
+  for (auto const &repr : orbits)
+    reprs.push_back(repr);
+
+  EXPECT_EQ((std::vector<TaskMapping>{{0, 1}, {1, 0}}), reprs)
+    << "Representatives iterated in order of equivalence classes.";
+}
+
+TEST(TMORsTest, CanCopyAndMoveRepresentatives)
+{
+  auto mappings(all_mappings(3u, 10u));
+
+  TMORs orbits;
+  orbits.insert_all(mappings.begin(), mappings.end());
+
+  TMORs orbits_copy(orbits);
+
+  ASSERT_EQ(orbits, orbits_copy)
+    << "Copied representatives equal.";
+
+  for (auto i = 0u; i < mappings.size(); ++i) {
+    EXPECT_EQ(std::make_pair(false, i), orbits_copy.insert(mappings[i]))
+      << "Equivalence classes preserved by copy.";
+  }
+
+  TMORs orbits_moved(std::move(orbits_copy));
+
+  EXPECT_EQ(orbits, orbits_moved)
+    << "Moved representatives equal.";
+
+  EXPECT_EQ(0u, orbits_copy.num_orbits())
+    << "Moved from representatives empty.";
+
+  EXPECT_FALSE(orbits_copy.is_repr(mappings[0]))
+    << "Moved from representatives empty.";
+
+  EXPECT_EQ(std::make_pair(true, 0u), orbits_copy.insert(mappings[1]))
+    << "Can insert into moved from representatives.";
+}
+
+TEST(TMORsTest, CanInsertRepresentativesConcurrently)
+{
+  enum : unsigned { NUM_THREADS = 8u };
+
+  auto mappings(all_mappings(4u, 12u));
+
+  TMORs orbits;
+  std::vector<std::vector<std::pair<TaskMapping, unsigned>>>
+    inserted(NUM_THREADS);
+
+  std::vector<std::thread> threads;
+  for (unsigned t = 0u; t < NUM_THREADS; ++t) {
+    threads.emplace_back([&, t]{
+      // every thread inserts every mapping, in different orders
+      for (auto i = 0u; i < mappings.size(); ++i) {
+        auto const &mapping(mappings[(i + t * 997u) % mappings.size()]);
+
+        orbits.is_repr(mapping);
+        inserted[t].emplace_back(mapping, orbits.insert(mapping).second);
+      }
+    });
+  }
+
+  for (auto &thread : threads)
+    thread.join();
+
+  ASSERT_EQ(mappings.size(), orbits.num_orbits())
+    << "Number of orbits correct.";
+
+  std::set<TaskMapping> reprs;
+  for (auto const &repr : orbits)
+    reprs.insert(repr);
+
+  EXPECT_EQ(std::set<TaskMapping>(mappings.begin(), mappings.end()), reprs)
+    << "Equivalence classes dense.";
+
+  for (auto const &thread_inserted : inserted) {
+    for (auto const &ins : thread_inserted) {
+      EXPECT_EQ(ins.first, orbits.orbit_repr(ins.second))
+        << "Equivalence classes consistent across threads.";
+    }
+  }
+}
+
+TEST(TMORsTest, CanStoreRepresentativesInMappedFile)
+{
+  enum : unsigned { NUM_THREADS = 4u };
+
+  char directory_template[] = "/tmp/mpsym_tmors_XXXXXX";
+  ASSERT_NE(nullptr, mkdtemp(directory_template));
+
+  std::string file(std::string(directory_template) + "/reprs");
+
+  auto mappings(all_mappings(3u, 12u));
+
+  {
+    auto orbits(TMORs::mapped(file, 3u, 11u, mappings.size()));
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0u; t < NUM_THREADS; ++t) {
+      threads.emplace_back([&, t]{
+        for (auto i = 0u; i < mappings.size(); ++i)
+          orbits.insert(mappings[(i + t * 997u) % mappings.size()]);
+      });
+    }
+
+    for (auto &thread : threads)
+      thread.join();
+
+    ASSERT_EQ(mappings.size(), orbits.num_orbits())
+      << "Number of orbits correct.";
+
+    EXPECT_FALSE(orbits.is_repr(TaskMapping({0, 1, 300})))
+      << "Mapping not representable is not representative.";
+
+    EXPECT_THROW(orbits.insert(TaskMapping({0, 1})), std::invalid_argument)
+      << "Inserting mapping of wrong size fails.";
+  }
+
+  auto orbits(TMORs::mapped(file, 3u, 11u, 0u));
+
+  ASSERT_EQ(mappings.size(), orbits.num_orbits())
+    << "Representatives persist after reopening.";
+
+  std::set<TaskMapping> reprs;
+  for (auto const &repr : orbits)
+    reprs.insert(repr);
+
+  EXPECT_EQ(std::set<TaskMapping>(mappings.begin(), mappings.end()), reprs)
+    << "Representatives persist after reopening.";
+
+  for (auto i = 0u; i < mappings.size(); ++i) {
+    auto ins(orbits.insert(mappings[i]));
+
+    EXPECT_FALSE(ins.first)
+      << "Reinserting representative yields existing orbit.";
+
+    EXPECT_EQ(mappings[i], orbits.orbit_repr(ins.second))
+      << "Equivalence classes persist after reopening.";
+  }
+
+  EXPECT_THROW(orbits.insert(TaskMapping({0, 0, 12})), std::length_error)
+    << "Inserting into full representatives fails.";
+
+  EXPECT_THROW(TMORs::mapped(file, 4u, 11u, 0u), std::invalid_argument)
+    << "Opening representatives with different mapping size fails.";
+
+  std::remove(file.c_str());
+  rmdir(directory_template);
+}
@@ -5,6 +5,10 @@
 #include <memory>
 #include <thread>
 
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
 #include "gmock/gmock.h"
 
 #include "timeout.hpp"
@@ -97,4 +101,92 @@ TEST(TimeoutTest, CanTimeoutFunction)
   wait_for_timed_out_threads();
 }
 
+TEST(TimeoutTest, CanTimeoutAbortableFunctionOnCallingThread)
+{
+  auto caller(std::this_thread::get_id());
+
+  flag aborted_after_return;
+
+  EXPECT_EQ(42,
+            run_abortable_with_timeout("no_timeout",
+                                       ms(50),
+                                       [&](flag aborted)
+                                       {
+                                         EXPECT_EQ(caller, std::this_thread::get_id())
+                                           << "Function runs on calling thread.";
+
+                                         aborted_after_return = aborted;
+
+                                         return 42;
+                                       }))
+    << "Function returns before timeout.";
+
+  sleep(ms(100));
+
+  EXPECT_FALSE(is_set(aborted_after_return))
+    << "Deadline cancelled after function returns.";
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_THROW_WITH_MESSAGE(
+      run_abortable_with_timeout("timeout",
+                                 ms(10 * (3 - i)),
+                                 [&](flag aborted)
+                                 {
+                                   EXPECT_EQ(caller, std::this_thread::get_id())
+                                     << "Function runs on calling thread.";
+
+                                   while (!is_set(aborted))
+                                     sleep(ms(1));
+
+                                   throw AbortedError("timeout");
+                                 }),
+      TimeoutError,
+      "timeout timeout")
+        << "Function timeout yields exception.";
+  }
+}
+
+TEST(TimeoutTest, CanTimeoutAbortableFunctionAfterFork)
+{
+  // make sure that the timer thread has been started before forking
+  EXPECT_EQ(42,
+            run_abortable_with_timeout("no_timeout",
+                                       ms(50),
+                                       [](flag) { return 42; }))
+    << "Function returns before timeout.";
+
+  pid_t pid = fork();
+  ASSERT_NE(-1, pid);
+
+  if (pid == 0) {
+    bool timed_out = false;
+
+    try {
+      run_abortable_with_timeout("timeout",
+                                 ms(10),
+                                 [](flag aborted)
+                                 {
+                                   for (int i = 0; i < 1000; ++i) {
+                                     if (is_set(aborted))
+                                       throw AbortedError("timeout");
+
+                                     sleep(ms(1));
+                                   }
+
+                                   return 0;
+                                 });
+    } catch (TimeoutError const &) {
+      timed_out = true;
+    }
+
+    _exit(timed_out ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  int status;
+  ASSERT_EQ(pid, waitpid(pid, &status, 0));
+
+  EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS)
+    << "Function timeout yields exception in forked child process.";
+}
+
 } // anonymous namespace